@@ -2,17 +2,48 @@
 #include <mach/mach.h>
 #endif
 
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(__GLIBC__) && !defined(DISABLE_ALLOC_TRACKING)
+#define ALLOC_TRACKING
+#include <malloc.h>
+#endif
+
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 #include <unistd.h>
+#include <algorithm>
 #include <array>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <cxxabi.h>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <new>
 #include <numeric>
+#include <sstream>
+#include <thread>
 
 #include <map>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 
 // Google Sparse Hash
 #include <sparsepp/spp.h>
@@ -39,6 +70,7 @@
 #include <poplar-trie/poplar.hpp>
 
 #include "cmdline.h"
+#include "keygen.hpp"
 
 size_t get_process_size() {
 #ifdef __APPLE__
@@ -55,523 +87,4159 @@ size_t get_process_size() {
 #endif
 }
 
-class timer {
-  public:
-    using hrc = std::chrono::high_resolution_clock;
+/**
+ *  Heap accounting
+ *
+ *  On glibc, the malloc family is interposed so that every allocation of the process is counted, including
+ *  those made in C code (libart's calloc/malloc, cedar's realloc) and in libJudy. Sizes are taken from
+ *  malloc_usable_size(), i.e., they include the slack of each chunk but not the allocator's free lists.
+ *
+ *  To keep the hooks off the critical path of the timed loops, each thread counts in its own slot with plain
+ *  loads and stores, and the slots are summed only when the totals are read. The slot of an exiting thread is
+ *  folded into the retired totals and reused. The peak is that of each thread summed, which is exact as long as
+ *  a single thread allocates within a phase and an upper bound otherwise.
+ */
+namespace alloc_tracker {
 
-    timer() = default;
+// Counters owned by one thread; atomic only so that other threads may read them.
+struct alignas(64) thread_counters {
+    std::atomic<int64_t> live_bytes{0};
+    std::atomic<int64_t> peak_bytes{0};
+    std::atomic<uint64_t> num_allocs{0};
+    bool used = false;
+};
 
-    template <class Period = std::ratio<1>>
-    double get() const {
-        return std::chrono::duration<double, Period>(hrc::now() - tp_).count();
-    }
+constexpr size_t MAX_THREADS = 256;
 
-  private:
-    hrc::time_point tp_{hrc::now()};
-};
+thread_counters g_slots[MAX_THREADS];
+thread_counters g_shared;  // of the threads beyond MAX_THREADS, updated with read-modify-writes
+int64_t g_retired_live_bytes = 0;
+uint64_t g_retired_num_allocs = 0;
+std::atomic_flag g_lock = ATOMIC_FLAG_INIT;  // for the slot assignment and the totals
+pthread_key_t g_exit_key;
+bool g_exit_key_created = false;
+thread_local thread_counters* t_slot = nullptr;
 
-template <size_t N>
-inline double get_average(const std::array<double, N>& ary) {
-    double sum = 0.0;
-    for (auto v : ary) {
-        sum += v;
+class lock_guard {
+  public:
+    lock_guard() {
+        while (g_lock.test_and_set(std::memory_order_acquire)) {
+        }
     }
-    return sum / N;
-}
-inline double get_average(const std::vector<double>& ary) {
-    double sum = 0.0;
-    for (auto v : ary) {
-        sum += v;
+    ~lock_guard() {
+        g_lock.clear(std::memory_order_release);
     }
-    return sum / ary.size();
+};
+
+// Called on thread exit through the key registered when the thread takes a slot.
+inline void release_slot(void* ptr) {
+    thread_counters* slot = static_cast<thread_counters*>(ptr);
+    lock_guard lock;
+    g_retired_live_bytes += slot->live_bytes.load(std::memory_order_relaxed);
+    g_retired_num_allocs += slot->num_allocs.load(std::memory_order_relaxed);
+    slot->live_bytes.store(0, std::memory_order_relaxed);
+    slot->peak_bytes.store(0, std::memory_order_relaxed);
+    slot->num_allocs.store(0, std::memory_order_relaxed);
+    slot->used = false;
+    t_slot = nullptr;
 }
 
-template <size_t N>
-inline double get_min(const std::array<double, N>& ary) {
-    double min = std::numeric_limits<double>::max();
-    for (auto v : ary) {
-        if (v < min) {
-            min = v;
-        }
+inline thread_counters* take_slot() {
+    lock_guard lock;
+    if (!g_exit_key_created) {
+        g_exit_key_created = pthread_key_create(&g_exit_key, release_slot) == 0;
     }
-    return min;
-}
-inline double get_min(const std::vector<double>& ary) {
-    double min = std::numeric_limits<double>::max();
-    for (auto v : ary) {
-        if (v < min) {
-            min = v;
+    t_slot = &g_shared;
+    for (thread_counters& slot : g_slots) {
+        if (!slot.used and g_exit_key_created) {
+            slot.used = true;
+            pthread_setspecific(g_exit_key, &slot);
+            t_slot = &slot;
+            break;
         }
     }
-    return min;
-}
-
-template <typename T>
-inline std::string realname() {
-    int status;
-    return abi::__cxa_demangle(typeid(T).name(), nullptr, nullptr, &status);
+    return t_slot;
 }
 
-/**
- *  STL and Google
- */
-enum class standard_map_types { STD_MAP, STD_HASH, GOOGLE_DENCE_HASH, GOOGLE_SPARSE_HASH, SPP };
-
-template <standard_map_types>
-struct standard_map_trait;
-
-template <>
-struct standard_map_trait<standard_map_types::STD_MAP> {
-    using type = std::map<std::string, int>;
-    static std::string name() {
-        return "std_map";
+inline void count(int64_t bytes, uint64_t allocs) {
+    thread_counters* slot = t_slot != nullptr ? t_slot : take_slot();
+    if (slot == &g_shared) {
+        slot->live_bytes.fetch_add(bytes, std::memory_order_relaxed);
+        slot->num_allocs.fetch_add(allocs, std::memory_order_relaxed);
+        return;
     }
-};
-template <>
-struct standard_map_trait<standard_map_types::STD_HASH> {
-    using type = std::unordered_map<std::string, int>;
-    static std::string name() {
-        return "std_unordered_map";
+    const int64_t live = slot->live_bytes.load(std::memory_order_relaxed) + bytes;
+    slot->live_bytes.store(live, std::memory_order_relaxed);
+    if (live > slot->peak_bytes.load(std::memory_order_relaxed)) {
+        slot->peak_bytes.store(live, std::memory_order_relaxed);
     }
-};
-template <>
-struct standard_map_trait<standard_map_types::GOOGLE_DENCE_HASH> {
-    using type = google::dense_hash_map<std::string, int>;
-    static std::string name() {
-        return "google_dense_hash_map";
+    slot->num_allocs.store(slot->num_allocs.load(std::memory_order_relaxed) + allocs, std::memory_order_relaxed);
+}
+
+inline void on_alloc(void* ptr) {
+#ifdef ALLOC_TRACKING
+    if (ptr != nullptr) {
+        count(static_cast<int64_t>(malloc_usable_size(ptr)), 1);
     }
-};
-template <>
-struct standard_map_trait<standard_map_types::GOOGLE_SPARSE_HASH> {
-    using type = google::sparse_hash_map<std::string, int>;
-    static std::string name() {
-        return "google_sparse_hash_map";
+#endif
+}
+inline void on_free(void* ptr) {
+#ifdef ALLOC_TRACKING
+    if (ptr != nullptr) {
+        count(-static_cast<int64_t>(malloc_usable_size(ptr)), 0);
     }
+#endif
+}
+// old_size is the usable size of the chunk before the reallocation
+inline void on_realloc(int64_t old_size, void* ptr) {
+#ifdef ALLOC_TRACKING
+    count((ptr != nullptr ? static_cast<int64_t>(malloc_usable_size(ptr)) : 0) - old_size, ptr != nullptr);
+#endif
+}
+
+struct totals {
+    int64_t live_bytes = 0;
+    int64_t peak_bytes = 0;
+    uint64_t num_allocs = 0;
 };
-template <>
-struct standard_map_trait<standard_map_types::SPP> {
-    using type = spp::sparse_hash_map<std::string, int>;
-    static std::string name() {
-        return "sparsepp";
+
+// Sums the slots; with reset_peak, the peak of each slot is restarted from its live bytes.
+inline totals get_totals(bool reset_peak = false) {
+    lock_guard lock;
+    totals t;
+    t.live_bytes = t.peak_bytes = g_retired_live_bytes;
+    t.num_allocs = g_retired_num_allocs;
+    auto add = [&](thread_counters& slot) {
+        const int64_t live = slot.live_bytes.load(std::memory_order_relaxed);
+        if (reset_peak) {
+            slot.peak_bytes.store(live, std::memory_order_relaxed);
+        }
+        t.live_bytes += live;
+        t.peak_bytes += std::max(live, slot.peak_bytes.load(std::memory_order_relaxed));
+        t.num_allocs += slot.num_allocs.load(std::memory_order_relaxed);
+    };
+    for (thread_counters& slot : g_slots) {
+        add(slot);
     }
-};
+    add(g_shared);
+    return t;
+}
 
-template <standard_map_types T>
-class standard_map_wrapper {
+inline int64_t live_bytes() {
+    return get_totals().live_bytes;
+}
+
+constexpr bool enabled() {
+#ifdef ALLOC_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Heap usage between start() and stop(); the peak is relative to the live bytes at start().
+class phase {
   public:
-    explicit standard_map_wrapper(const std::vector<std::string>&) {
-        if constexpr (T == standard_map_types::GOOGLE_DENCE_HASH) {
-            dict_.set_empty_key("");
-        }
+    void start() {
+        const totals t = get_totals(true);
+        live_beg_ = t.live_bytes;
+        allocs_beg_ = t.num_allocs;
+    }
+    void stop() {
+        const totals t = get_totals();
+        live_bytes_ = t.live_bytes - live_beg_;
+        peak_bytes_ = t.peak_bytes - live_beg_;
+        num_allocs_ = t.num_allocs - allocs_beg_;
     }
 
-    static std::string name() {
-        return standard_map_trait<T>::name();
+    int64_t live_bytes() const {
+        return live_bytes_;
     }
-    bool insert(const std::string& key) {
-        return dict_.insert(std::make_pair(key, 1)).second;
+    int64_t peak_bytes() const {
+        return peak_bytes_;
     }
-    bool search(const std::string& key) {
-        return dict_.find(key) != dict_.end();
+    uint64_t num_allocs() const {
+        return num_allocs_;
     }
-    void show_stat(std::ostream& os) const {}
 
   private:
-    typename standard_map_trait<T>::type dict_;
+    int64_t live_beg_ = 0;
+    uint64_t allocs_beg_ = 0;
+    int64_t live_bytes_ = 0;
+    int64_t peak_bytes_ = 0;
+    uint64_t num_allocs_ = 0;
 };
 
+}  // namespace alloc_tracker
+
 /**
- *  Tessil impl.
+ *  Transparent huge pages
+ *
+ *  With "always", the interposed malloc family advises the kernel to back the huge-page-aligned part of every
+ *  large allocation (e.g., the chunks of compact_vector, cedar's array and the buckets of hash tables) with huge
+ *  pages, regardless of the system-wide "madvise" setting. With "never", they are disabled for the process.
  */
-enum class tsl_map_types { ARRAY_HASH, HAT_TRIE, HOPSCOTCH, ROBIN };
+namespace huge_pages {
 
-template <tsl_map_types>
-struct tsl_map_trait;
+constexpr size_t HUGE_PAGE_BYTES = size_t(2) << 20;
 
-template <>
-struct tsl_map_trait<tsl_map_types::ARRAY_HASH> {
-    using type = tsl::array_map<char, int>;
-    static std::string name() {
-        return "tsl_array_hash";
-    }
-};
-template <>
-struct tsl_map_trait<tsl_map_types::HAT_TRIE> {
-    using type = tsl::htrie_map<char, int>;
-    static std::string name() {
-        return "tsl_hat_trie";
+bool g_always = false;
+
+inline void on_alloc(void* ptr, size_t size) {
+#if defined(ALLOC_TRACKING) && defined(MADV_HUGEPAGE)
+    if (g_always and ptr != nullptr and size >= HUGE_PAGE_BYTES) {
+        const uintptr_t beg = (reinterpret_cast<uintptr_t>(ptr) + HUGE_PAGE_BYTES - 1) & ~(HUGE_PAGE_BYTES - 1);
+        const uintptr_t end = (reinterpret_cast<uintptr_t>(ptr) + size) & ~(HUGE_PAGE_BYTES - 1);
+        if (beg < end) {
+            madvise(reinterpret_cast<void*>(beg), end - beg, MADV_HUGEPAGE);
+        }
     }
-};
-template <>
-struct tsl_map_trait<tsl_map_types::HOPSCOTCH> {
-    using type = tsl::hopscotch_map<std::string, int>;
-    static std::string name() {
-        return "tsl_hopscotch_map";
+#endif
+}
+
+// Applies the mode "default", "always" or "never"; returns false if it is not available.
+inline bool set_mode(const std::string& mode) {
+    if (mode == "always") {
+#if defined(ALLOC_TRACKING) && defined(MADV_HUGEPAGE)
+        g_always = true;
+        return true;
+#else
+        return false;
+#endif
     }
-};
-template <>
-struct tsl_map_trait<tsl_map_types::ROBIN> {
-    using type = tsl::robin_map<std::string, int>;
-    static std::string name() {
-        return "tsl_robin_map";
+    if (mode == "never") {
+#ifdef PR_SET_THP_DISABLE
+        return prctl(PR_SET_THP_DISABLE, 1, 0, 0, 0) == 0;
+#else
+        return false;
+#endif
     }
-};
+    return true;
+}
 
-template <tsl_map_types T>
-class tsl_map_wrapper {
-  public:
-    explicit tsl_map_wrapper(const std::vector<std::string>&) {}
+// System-wide setting ("always", "madvise" or "never"); empty if unknown.
+inline std::string system_mode() {
+    std::ifstream ifs("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string line;
+    std::getline(ifs, line);
+    const size_t beg = line.find('['), end = line.find(']');
+    return beg < end and end != std::string::npos ? line.substr(beg + 1, end - beg - 1) : std::string();
+}
 
-    static std::string name() {
-        return tsl_map_trait<T>::name();
+}  // namespace huge_pages
+
+#ifdef ALLOC_TRACKING
+extern "C" {
+extern void* __libc_malloc(size_t);
+extern void* __libc_calloc(size_t, size_t);
+extern void* __libc_realloc(void*, size_t);
+extern void* __libc_memalign(size_t, size_t);
+extern void __libc_free(void*);
+
+void* malloc(size_t size) {
+    void* ptr = __libc_malloc(size);
+    alloc_tracker::on_alloc(ptr);
+    huge_pages::on_alloc(ptr, size);
+    return ptr;
+}
+void* calloc(size_t num, size_t size) {
+    void* ptr = __libc_calloc(num, size);
+    alloc_tracker::on_alloc(ptr);
+    huge_pages::on_alloc(ptr, num * size);
+    return ptr;
+}
+void* realloc(void* old_ptr, size_t size) {
+    int64_t old_size = old_ptr != nullptr ? malloc_usable_size(old_ptr) : 0;
+    void* ptr = __libc_realloc(old_ptr, size);
+    if (ptr != nullptr or size == 0) {
+        alloc_tracker::on_realloc(old_size, ptr);
+        huge_pages::on_alloc(ptr, size);
     }
-    bool insert(const std::string& key) {
-        if constexpr ((T == tsl_map_types::ARRAY_HASH) or (T == tsl_map_types::HAT_TRIE)) {
-            return dict_.insert(key, 1).second;
-        } else {
-            return dict_.insert({key, 1}).second;
-        }
+    return ptr;
+}
+void* memalign(size_t alignment, size_t size) {
+    void* ptr = __libc_memalign(alignment, size);
+    alloc_tracker::on_alloc(ptr);
+    huge_pages::on_alloc(ptr, size);
+    return ptr;
+}
+void* aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+int posix_memalign(void** memptr, size_t alignment, size_t size) {
+    if (alignment % sizeof(void*) != 0 or (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
     }
-    bool search(const std::string& key) {
-        return dict_.find(key) != dict_.end();
+    void* ptr = memalign(alignment, size);
+    if (ptr == nullptr) {
+        return ENOMEM;
     }
-    void show_stat(std::ostream& os) const {}
+    *memptr = ptr;
+    return 0;
+}
+void free(void* ptr) {
+    alloc_tracker::on_free(ptr);
+    __libc_free(ptr);
+}
+}
 
-  private:
-    typename tsl_map_trait<T>::type dict_;
-};
+// operator new/delete are routed to the tracked malloc/free regardless of how the C++ runtime implements them.
+void* operator new(size_t size) {
+    void* ptr = std::malloc(size != 0 ? size : 1);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return std::malloc(size != 0 ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return std::malloc(size != 0 ? size : 1);
+}
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+#endif
 
-/**
- *  Judy
- */
-class judy_wrapper {
+inline void show_heap(std::ostream& os, const std::string& pfx, const alloc_tracker::phase& phase) {
+    os << pfx << "_heap_live_bytes:" << phase.live_bytes() << '\n'
+       << pfx << "_heap_peak_bytes:" << phase.peak_bytes() << '\n'
+       << pfx << "_heap_allocs:" << phase.num_allocs() << '\n';
+}
+
+class timer {
   public:
-    explicit judy_wrapper(const std::vector<std::string>&) {}
+    using hrc = std::chrono::high_resolution_clock;
 
-    ~judy_wrapper() {
-        Word_t bytes = 0;
-        JSLFA(bytes, dic_);
-    }
-    static std::string name() {
-        return "judySL";
-    }
-    bool insert(const std::string& key) {
-        Pvoid_t ptr = nullptr;
-        JSLI(ptr, dic_, reinterpret_cast<const uint8_t*>(key.c_str()));
-        auto p_word = reinterpret_cast<PWord_t>(ptr);
-        *p_word = 1;
-        return true;
-    }
-    bool search(const std::string& key) {
-        Pvoid_t ptr = nullptr;
-        JSLG(ptr, dic_, reinterpret_cast<const uint8_t*>(key.c_str()));
-        auto p_word = reinterpret_cast<PWord_t>(ptr);
-        return *p_word == 1;
+    timer() = default;
+
+    template <class Period = std::ratio<1>>
+    double get() const {
+        return std::chrono::duration<double, Period>(hrc::now() - tp_).count();
     }
-    void show_stat(std::ostream& os) const {}
 
   private:
-    Pvoid_t dic_ = nullptr;
+    hrc::time_point tp_{hrc::now()};
 };
 
-/**
- *  ART
- */
-class art_wrapper {
+// Log-linear histogram of latencies in nanoseconds in the manner of HdrHistogram: values below 2^SUB_BITS are
+// recorded exactly and larger values within a relative error of 2^-(SUB_BITS-1).
+class latency_histogram {
   public:
-    explicit art_wrapper(const std::vector<std::string>&) {
-        art_tree_init(&dict_);
+    static constexpr uint32_t SUB_BITS = 7;
+    static constexpr uint64_t HALF = uint64_t(1) << (SUB_BITS - 1);
+
+    latency_histogram() : counts_(bucket_of(UINT64_MAX) + 1) {}
+
+    void record(uint64_t ns) {
+        ++counts_[bucket_of(ns)];
+        ++total_;
+        sum_ += ns;
+        max_ = std::max(max_, ns);
     }
-    ~art_wrapper() {
-        destroy_art_tree(&dict_);
+    void merge(const latency_histogram& other) {
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        total_ += other.total_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
     }
-    static std::string name() {
-        return "art";
+    void clear() {
+        std::fill(counts_.begin(), counts_.end(), 0);
+        total_ = sum_ = max_ = 0;
     }
-    bool insert(const std::string& key) {
-        uintptr_t value = 1;
-        return art_insert(&dict_, reinterpret_cast<const unsigned char*>(key.c_str()),
-                          static_cast<int>(key.length() + 1),  // with terminator
-                          reinterpret_cast<void*>(value)) == nullptr;
+
+    uint64_t size() const {
+        return total_;
     }
-    bool search(const std::string& key) {
-        return reinterpret_cast<uintptr_t>(art_search(&dict_, reinterpret_cast<const unsigned char*>(key.c_str()),
-                                                      static_cast<int>(key.length()) + 1  // with terminator
-                                                      )) == 1;
+    double mean() const {
+        return total_ != 0 ? double(sum_) / total_ : 0.0;
+    }
+    uint64_t max() const {
+        return max_;
+    }
+    // Returns the lowest value of the bucket containing the q-quantile (0 <= q <= 1).
+    uint64_t percentile(double q) const {
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * total_)));
+        uint64_t count = 0;
+        for (size_t i = 0; i < counts_.size(); ++i) {
+            count += counts_[i];
+            if (count >= rank) {
+                return std::min(value_of(i), max_);
+            }
+        }
+        return max_;
     }
-    void show_stat(std::ostream& os) const {}
 
   private:
-    art_tree dict_;
-};
-
-/**
- *  Cedar
- */
-enum class cedar_types { TRIE, MP_TRIE };
+    std::vector<uint64_t> counts_;
+    uint64_t total_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t max_ = 0;
 
-template <cedar_types>
-struct cedar_wrapper_trait;
-template <>
-struct cedar_wrapper_trait<cedar_types::TRIE> {
-    using type = cedar::da<int, -1, -2, false>;
-    static std::string name() {
-        return "cedar";
+    static size_t bucket_of(uint64_t v) {
+        if (v < (HALF << 1)) {
+            return v;
+        }
+        uint32_t shift = (63 - __builtin_clzll(v)) - SUB_BITS + 1;
+        return shift * HALF + (v >> shift);
     }
-};
-template <>
-struct cedar_wrapper_trait<cedar_types::MP_TRIE> {
-    using type = cedarpp::da<int, -1, -2, false>;
-    static std::string name() {
-        return "cedarpp";
+    static uint64_t value_of(size_t i) {
+        if (i < (HALF << 1)) {
+            return i;
+        }
+        uint32_t shift = i / HALF - 1;
+        return (i - shift * HALF) << shift;
     }
 };
 
-template <cedar_types T>
-class cedar_wrapper {
+inline uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Median cost of a pair of back-to-back now_ns() calls, which is subtracted from every per-operation sample.
+inline uint64_t measure_timer_overhead() {
+    std::vector<uint64_t> samples(100000);
+    for (auto& v : samples) {
+        uint64_t beg = now_ns();
+        v = now_ns() - beg;
+    }
+    std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+    return samples[samples.size() / 2];
+}
+
+inline void show_latency(std::ostream& os, const std::string& pfx, const latency_histogram& hist) {
+    os << pfx << "_ns_mean:" << hist.mean() << '\n'
+       << pfx << "_ns_p50:" << hist.percentile(0.5) << '\n'
+       << pfx << "_ns_p90:" << hist.percentile(0.9) << '\n'
+       << pfx << "_ns_p99:" << hist.percentile(0.99) << '\n'
+       << pfx << "_ns_p999:" << hist.percentile(0.999) << '\n'
+       << pfx << "_ns_max:" << hist.max() << '\n';
+}
+
+// Hardware counters of the calling thread via perf_event_open(2), accumulated over start()/stop() intervals.
+// Each event is opened individually so that the others stay usable when one is not supported or access is
+// restricted by perf_event_paranoid; such events are reported as unavailable.
+class perf_counters {
   public:
-    explicit cedar_wrapper(const std::vector<std::string>&) {}
+    enum event_types { INSTRUCTIONS, BRANCH_MISSES, LLC_MISSES, DTLB_MISSES, NUM_EVENTS };
 
-    static std::string name() {
-        return cedar_wrapper_trait<T>::name();
+    perf_counters() {
+        fds_.fill(-1);
+        totals_.fill(0.0);
+#ifdef __linux__
+        const std::array<std::pair<uint32_t, uint64_t>, NUM_EVENTS> configs = {{
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                     (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        }};
+        for (int i = 0; i < NUM_EVENTS; ++i) {
+            perf_event_attr attr = {};
+            attr.size = sizeof(attr);
+            attr.type = configs[i].first;
+            attr.config = configs[i].second;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds_[i] = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
     }
-    bool insert(const std::string& key) {
-        dict_.update(key.c_str(), key.length()) = 1;
-        return true;
+    ~perf_counters() {
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
     }
-    bool search(const std::string& key) {
-        return dict_.template exactMatchSearch<int>(key.c_str(), key.length()) == 1;
+
+    perf_counters(const perf_counters&) = delete;
+    perf_counters& operator=(const perf_counters&) = delete;
+
+    static const char* name(int i) {
+        static const char* names[NUM_EVENTS] = {"instructions", "branch_misses", "llc_misses", "dtlb_misses"};
+        return names[i];
     }
-    void show_stat(std::ostream& os) const {
-        os << "capacity:" << dict_.capacity() << "\n";
-        os << "size:" << dict_.size() << "\n";
-        if constexpr (T == cedar_types::MP_TRIE) {
-            os << "length:" << dict_.length() << "\n";
-        }
-        os << "total_size:" << dict_.total_size() << "\n";
-        os << "unit_size:" << dict_.unit_size() << "\n";
-        os << "nonzero_size:" << dict_.nonzero_size() << "\n";
-        if constexpr (T == cedar_types::MP_TRIE) {
-            os << "nonzero_length:" << dict_.nonzero_length() << "\n";
+    bool available(int i) const {
+        return fds_[i] >= 0;
+    }
+    double total(int i) const {
+        return totals_[i];
+    }
+
+    void start() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+    void stop() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+        for (int i = 0; i < NUM_EVENTS; ++i) {
+            uint64_t buf[3] = {};  // value, time_enabled, time_running
+            if (fds_[i] < 0 or read(fds_[i], buf, sizeof(buf)) != sizeof(buf)) {
+                continue;
+            }
+            // scale up when the event was multiplexed with others
+            totals_[i] += buf[2] != 0 ? double(buf[0]) * buf[1] / buf[2] : 0.0;
+        }
+#endif
+    }
+
+  private:
+    std::array<int, NUM_EVENTS> fds_;
+    std::array<double, NUM_EVENTS> totals_;
+};
+
+inline void show_perf(std::ostream& os, const std::string& pfx, const std::string& unit, const perf_counters& perf,
+                      size_t num_ops) {
+    for (int i = 0; i < perf_counters::NUM_EVENTS; ++i) {
+        os << pfx << '_' << perf_counters::name(i) << "_per_" << unit << ':';
+        if (perf.available(i)) {
+            os << perf.total(i) / num_ops << '\n';
+        } else {
+            os << "unavailable\n";
+        }
+    }
+}
+
+// Binds the calling thread to the given logical CPU (no-op except on Linux).
+inline bool pin_thread(unsigned cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+// The CPUs first, first + 1, ..., first + num - 1 modulo num_cpus, with consecutive ones as ranges (e.g., "6-7,0-1").
+inline std::string cpu_list(unsigned first, unsigned num, unsigned num_cpus) {
+    std::string list;
+    for (unsigned i = 0; i < num;) {
+        const unsigned beg = (first + i) % num_cpus;
+        unsigned end = beg;
+        for (++i; i < num and (first + i) % num_cpus == end + 1; ++i) {
+            ++end;
+        }
+        list += (list.empty() ? "" : ",") + std::to_string(beg);
+        if (end != beg) {
+            list += "-" + std::to_string(end);
+        }
+    }
+    return list;
+}
+
+// Restricts the memory allocated from now on by the calling thread and the threads it creates to the given NUMA
+// node (no-op except on Linux).
+inline bool bind_numa_node(int node) {
+#ifdef __linux__
+    constexpr size_t BITS = 8 * sizeof(unsigned long);
+    std::array<unsigned long, 16> mask = {};
+    if (node < 0 or size_t(node) >= mask.size() * BITS) {
+        return false;
+    }
+    mask[node / BITS] |= 1UL << (node % BITS);
+    return syscall(SYS_set_mempolicy, MPOL_BIND, mask.data(), mask.size() * BITS) == 0;
+#else
+    return false;
+#endif
+}
+
+// Size of the last-level cache, or 0 if unknown.
+inline size_t get_llc_size() {
+#if defined(__linux__) && defined(_SC_LEVEL3_CACHE_SIZE)
+    for (int name : {_SC_LEVEL3_CACHE_SIZE, _SC_LEVEL2_CACHE_SIZE}) {
+        long size = sysconf(name);
+        if (size > 0) {
+            return static_cast<size_t>(size);
+        }
+    }
+#endif
+    return 0;
+}
+
+// Evicts the caches and the TLB by writing to every cache line of an anonymous mapping twice as large as the
+// last-level cache and at least 32 MiB, which also spans more pages than the TLB holds. The mapping is not
+// allocated by malloc so that it is not counted in the heap usage.
+class cache_evictor {
+  public:
+    static constexpr size_t LINE_BYTES = 64;
+
+    cache_evictor() : size_(std::max<size_t>(2 * get_llc_size(), size_t(32) << 20)) {
+        void* ptr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr != MAP_FAILED) {
+            data_ = static_cast<volatile char*>(ptr);
+        }
+    }
+    ~cache_evictor() {
+        if (data_ != nullptr) {
+            munmap(const_cast<char*>(data_), size_);
+        }
+    }
+
+    cache_evictor(const cache_evictor&) = delete;
+    cache_evictor& operator=(const cache_evictor&) = delete;
+
+    size_t size() const {
+        return size_;
+    }
+
+    void evict() {
+        if (data_ == nullptr) {
+            return;
+        }
+        for (size_t i = 0; i < size_; i += LINE_BYTES) {
+            data_[i] = data_[i] + 1;
         }
-        os << "num_keys:" << dict_.num_keys() << "\n";
     }
 
   private:
-    typename cedar_wrapper_trait<T>::type dict_;
+    size_t size_ = 0;
+    volatile char* data_ = nullptr;
 };
 
 /**
- *  Poplar
+ *  Lines of a text file kept in one contiguous buffer.
+ *
+ *  The file is mapped privately and every '\n' is overwritten with '\0' in place, so each line is available as
+ *  a std::string_view that is followed by a terminator (which Judy, ART and Poplar rely on) without any per-line
+ *  allocation. Empty files and files whose last line lacks a newline at a page boundary are read into a heap
+ *  buffer instead.
  */
-enum class poplar_types {
-    PLAIN_BONSAI,
-    SEMI_COMPACT_BONSAI,
-    COMPACT_BONSAI,
-    PLAIN_FKHASH,
-    SEMI_COMPACT_FKHASH,
-    COMPACT_FKHASH,
+class key_arena {
+  public:
+    key_arena() = default;
+    ~key_arena() {
+        if (mapped_) {
+            munmap(data_, size_);
+        }
+    }
+
+    key_arena(const key_arena&) = delete;
+    key_arena& operator=(const key_arena&) = delete;
+
+    bool load(const std::string& fn) {
+        int fd = ::open(fn.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size_ = static_cast<size_t>(st.st_size);
+
+        const bool needs_tail = size_ == 0 or size_ % ::getpagesize() == 0;
+        if (!needs_tail) {
+            void* ptr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (ptr != MAP_FAILED) {
+                data_ = static_cast<char*>(ptr);
+                mapped_ = true;
+            }
+        }
+        if (!mapped_) {
+            buffer_.resize(size_ + 1);
+            size_t pos = 0;
+            while (pos < size_) {
+                ssize_t n = ::read(fd, buffer_.data() + pos, size_ - pos);
+                if (n <= 0) {
+                    ::close(fd);
+                    return false;
+                }
+                pos += n;
+            }
+            data_ = buffer_.data();
+        }
+        ::close(fd);
+
+        split_();
+        return true;
+    }
+
+    // Copies the strings into the arena in the same layout.
+    void assign(const std::vector<std::string>& strs) {
+        if (mapped_) {
+            munmap(data_, size_);
+            mapped_ = false;
+        }
+        size_ = 0;
+        for (const std::string& str : strs) {
+            size_ += str.size() + 1;
+        }
+        buffer_.assign(size_ + 1, '\0');
+        data_ = buffer_.data();
+
+        lines_.clear();
+        lines_.reserve(strs.size());
+        for (size_t pos = 0, i = 0; i < strs.size(); ++i) {
+            std::memcpy(data_ + pos, strs[i].data(), strs[i].size());
+            lines_.emplace_back(data_ + pos, strs[i].size());
+            pos += strs[i].size() + 1;
+        }
+    }
+
+    size_t size() const {
+        return lines_.size();
+    }
+    std::string_view operator[](size_t i) const {
+        return lines_[i];
+    }
+    std::vector<std::string_view>::const_iterator begin() const {
+        return lines_.begin();
+    }
+    std::vector<std::string_view>::const_iterator end() const {
+        return lines_.end();
+    }
+
+  private:
+    char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::vector<char> buffer_;
+    std::vector<std::string_view> lines_;
+
+    void split_() {
+        // bytes past the end of file up to the page boundary are zero-filled, so data_[size_] is a terminator
+        const char* end = data_ + size_;
+        lines_.reserve(std::count(data_, data_ + size_, '\n') + 1);
+        for (char* beg = data_; beg < end;) {
+            char* lf = static_cast<char*>(std::memchr(beg, '\n', end - beg));
+            if (lf == nullptr) {
+                lf = data_ + size_;
+            }
+            *lf = '\0';
+            lines_.emplace_back(beg, lf - beg);
+            beg = lf + 1;
+        }
+    }
+};
+
+/**
+ *  Keys streamed without holding the keyset in memory.
+ *
+ *  A source is either a file read in fixed-size chunks or "gen:<preset>:<num_keys>", the keys of keygen with a
+ *  preset and the seed. Each key is a std::string_view followed by a terminator, as with key_arena, that stays
+ *  valid until the next call. Generated keys can also be regenerated at random by index.
+ */
+class key_stream {
+  public:
+    static constexpr size_t CHUNK_BYTES = size_t(1) << 20;
+
+    key_stream() = default;
+    ~key_stream() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    key_stream(const key_stream&) = delete;
+    key_stream& operator=(const key_stream&) = delete;
+
+    bool open(const std::string& spec, uint64_t seed) {
+        if (spec.compare(0, 4, "gen:") == 0) {
+            const size_t colon = spec.find(':', 4);
+            if (colon == std::string::npos) {
+                return false;
+            }
+            try {
+                keygen::config conf = keygen::config::preset(spec.substr(4, colon - 4));
+                conf.seed = seed;
+                gen_ = std::make_unique<keygen::generator>(conf);
+                size_t pos = 0;
+                num_keys_ = std::stoull(spec.substr(colon + 1), &pos);
+                if (colon + 1 + pos != spec.size()) {
+                    return false;
+                }
+            } catch (const std::exception&) {
+                return false;
+            }
+            return true;
+        }
+        fd_ = ::open(spec.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            return false;
+        }
+#ifdef __linux__
+        posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+        buffer_.resize(CHUNK_BYTES + 1);
+        return true;
+    }
+
+    bool generated() const {
+        return gen_ != nullptr;
+    }
+
+    // Restarts from the first key.
+    void rewind() {
+        index_ = 0;
+        if (fd_ >= 0) {
+            ::lseek(fd_, 0, SEEK_SET);
+            beg_ = end_ = 0;
+            eof_ = false;
+        }
+    }
+
+    // Returns false at the end of the stream.
+    bool next(std::string_view& key) {
+        if (gen_) {
+            if (index_ == num_keys_) {
+                return false;
+            }
+            key = get(index_++);
+            return true;
+        }
+        for (;;) {
+            char* lf = static_cast<char*>(std::memchr(buffer_.data() + beg_, '\n', end_ - beg_));
+            if (lf != nullptr or (eof_ and beg_ < end_)) {
+                if (lf == nullptr) {
+                    lf = buffer_.data() + end_;  // the last line without a newline
+                }
+                *lf = '\0';
+                key = std::string_view(buffer_.data() + beg_, lf - (buffer_.data() + beg_));
+                beg_ = std::min<size_t>(end_, lf - buffer_.data() + 1);
+                return true;
+            }
+            if (eof_) {
+                return false;
+            }
+            fill_();
+        }
+    }
+
+    // The i-th generated key.
+    std::string_view get(uint64_t i) {
+        gen_->get(i, key_);
+        return key_;
+    }
+
+  private:
+    // file
+    int fd_ = -1;
+    std::vector<char> buffer_;
+    size_t beg_ = 0, end_ = 0;  // of the unread bytes in buffer_
+    bool eof_ = false;
+    // generator
+    std::unique_ptr<keygen::generator> gen_;
+    uint64_t num_keys_ = 0;
+    uint64_t index_ = 0;
+    std::string key_;
+
+    // Moves the partial line to the front and reads the next chunk after it; a line longer than the buffer
+    // doubles it.
+    void fill_() {
+        std::memmove(buffer_.data(), buffer_.data() + beg_, end_ - beg_);
+        end_ -= beg_;
+        beg_ = 0;
+        if (end_ == buffer_.size() - 1) {
+            buffer_.resize(2 * buffer_.size() - 1);
+        }
+        ssize_t n = ::read(fd_, buffer_.data() + end_, buffer_.size() - 1 - end_);
+        if (n <= 0) {
+            eof_ = true;
+            buffer_[end_] = '\0';
+            return;
+        }
+        end_ += n;
+    }
+};
+
+/**
+ *  Insertion orders
+ */
+// Permutes the keys into one of the orders:
+//  - file: as is
+//  - sorted / reverse: lexicographically ascending / descending
+//  - shuffle: uniformly at random
+//  - clustered: keys sharing the first cluster_bytes bytes are consecutive, with clusters and keys within each
+//    cluster in random order
+inline bool reorder_keys(std::vector<std::string_view>& keys, const std::string& order, uint64_t seed,
+                         size_t cluster_bytes = 3 /* a CJK character in UTF-8 */) {
+    auto shuffle = [&]() {
+        keygen::random rnd(seed);
+        for (size_t i = keys.size(); i > 1; --i) {
+            std::swap(keys[i - 1], keys[rnd.next_below(i)]);
+        }
+    };
+
+    if (order == "file") {
+        return true;
+    } else if (order == "sorted") {
+        std::sort(keys.begin(), keys.end());
+    } else if (order == "reverse") {
+        std::sort(keys.begin(), keys.end(), std::greater<>());
+    } else if (order == "shuffle") {
+        shuffle();
+    } else if (order == "clustered") {
+        shuffle();
+        auto rank = [&](std::string_view key) {
+            return std::make_pair(keygen::mix(seed, std::hash<std::string_view>()(key.substr(0, cluster_bytes))),
+                                  key.substr(0, cluster_bytes));
+        };
+        std::stable_sort(keys.begin(), keys.end(),
+                         [&](std::string_view a, std::string_view b) { return rank(a) < rank(b); });
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Writes the file back and drops it from the page cache so that the next read comes from the device.
+// Returns the file size, or 0 if it cannot be opened.
+inline size_t drop_file_cache(const std::string& fn) {
+    const int fd = ::open(fn.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    const size_t size = ::fstat(fd, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+    ::fsync(fd);
+#ifdef __linux__
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+    ::close(fd);
+    return size;
+}
+
+/**
+ *  Absent queries
+ */
+// Derives a string that is not in the keyset from a key:
+//  - random: a random string of the same length
+//  - mutate: one byte replaced
+//  - truncate: a proper prefix
+//  - extend: one to four bytes appended
+inline bool make_absent_queries(const key_arena& keys, const std::string& kind, size_t num, uint64_t seed,
+                                std::vector<std::string>& queries) {
+    const std::string alphabet = keygen::BASE_ALPHABET;
+    std::unordered_set<std::string_view> keyset(keys.begin(), keys.end());
+    keygen::random rnd(seed);
+
+    for (size_t trials = 0; queries.size() < num; ++trials) {
+        if (keys.size() == 0 or trials >= num * 100) {
+            return false;
+        }
+        std::string_view key = keys[rnd.next_below(keys.size())];
+        if (key.empty()) {
+            continue;
+        }
+        std::string query(key);
+        if (kind == "random") {
+            for (char& c : query) {
+                c = alphabet[rnd.next_below(alphabet.size())];
+            }
+        } else if (kind == "mutate") {
+            query[rnd.next_below(query.size())] = alphabet[rnd.next_below(alphabet.size())];
+        } else if (kind == "truncate") {
+            if (query.size() < 2) {
+                continue;
+            }
+            query.resize(1 + rnd.next_below(query.size() - 1));
+        } else if (kind == "extend") {
+            for (uint64_t n = 1 + rnd.next_below(4); n != 0; --n) {
+                query += alphabet[rnd.next_below(alphabet.size())];
+            }
+        } else {
+            return false;
+        }
+        if (keyset.find(query) == keyset.end()) {
+            queries.push_back(std::move(query));
+        }
+    }
+    return true;
+}
+
+/**
+ *  YCSB-style workloads
+ */
+enum class op_types : uint8_t { READ, UPDATE, INSERT };
+
+struct workload_op {
+    op_types type;
+    uint64_t key_id;
+};
+
+struct workload_spec {
+    uint32_t read = 0, update = 0, insert = 0;  // in percent
+    std::string key_dist;
+};
+
+// Accepts YCSB's core workloads "a" (50/50 read/update, zipf), "b" (95/5 read/update, zipf), "c" (read only,
+// zipf) and "d" (95/5 read/insert, latest), or a mix "<read>:<update>:<insert>" in percent (uniform).
+inline bool parse_workload(const std::string& str, workload_spec& spec) {
+    if (str == "a") {
+        spec = {50, 50, 0, "zipf"};
+    } else if (str == "b") {
+        spec = {95, 5, 0, "zipf"};
+    } else if (str == "c") {
+        spec = {100, 0, 0, "zipf"};
+    } else if (str == "d") {
+        spec = {95, 0, 5, "latest"};
+    } else {
+        if (std::sscanf(str.c_str(), "%u:%u:%u", &spec.read, &spec.update, &spec.insert) != 3) {
+            return false;
+        }
+        spec.key_dist = "uniform";
+    }
+    return spec.read + spec.update + spec.insert == 100;
+}
+
+// Zipfian ranks in [0, n) with the rejection-free method of Gray et al. (also used by YCSB), which needs
+// 0 <= theta < 1 (alpha diverges at 1).
+class zipfian_generator {
+  public:
+    zipfian_generator(uint64_t n, double theta) : n_(n), theta_(theta) {
+        double zeta2 = 0.0;
+        for (uint64_t i = 1; i <= n; ++i) {
+            zetan_ += 1.0 / std::pow(double(i), theta);
+            if (i == 2) {
+                zeta2 = zetan_;
+            }
+        }
+        alpha_ = 1.0 / (1.0 - theta);
+        eta_ = (1.0 - std::pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zetan_);
+    }
+
+    uint64_t next(keygen::random& rnd) const {
+        double u = rnd.next_double();
+        double uz = u * zetan_;
+        if (uz < 1.0) {
+            return 0;
+        }
+        if (uz < 1.0 + std::pow(0.5, theta_)) {
+            return 1;
+        }
+        return std::min<uint64_t>(n_ - 1, static_cast<uint64_t>(n_ * std::pow(eta_ * u - eta_ + 1.0, alpha_)));
+    }
+
+  private:
+    uint64_t n_;
+    double theta_;
+    double zetan_ = 0.0;
+    double alpha_ = 0.0;
+    double eta_ = 0.0;
 };
 
-template <poplar_types, uint64_t ChunkSize>
-struct poplar_wrapper_trait;
+// Pre-generates the operations so that random number generation stays out of the timed loop. The first
+// num_keys - (# of inserts) keys are loaded in advance and the rest are inserted in order. Key selection:
+//  - uniform: uniformly over the loaded keys
+//  - zipf: zipfian over the initially loaded keys, scrambled by hashing so that hot keys are scattered
+//  - hotspot: 80% of the operations go to the first 20% of the keys
+//  - latest: zipfian over the recency of insertion
+inline bool make_trace(const workload_spec& spec, uint64_t num_keys, uint64_t num_ops, double theta, uint64_t seed,
+                       std::vector<workload_op>& trace, uint64_t& num_loaded) {
+    keygen::random rnd(seed);
+
+    trace.resize(num_ops);
+    uint64_t num_inserts = 0;
+    for (auto& op : trace) {
+        uint64_t r = rnd.next_below(100);
+        op.type = r < spec.read ? op_types::READ : r < spec.read + spec.update ? op_types::UPDATE : op_types::INSERT;
+        num_inserts += op.type == op_types::INSERT;
+    }
+    if (num_inserts >= num_keys) {
+        return false;
+    }
+    num_loaded = num_keys - num_inserts;
+
+    std::unique_ptr<zipfian_generator> zipf;
+    if (spec.key_dist == "zipf" or spec.key_dist == "latest") {
+        zipf = std::make_unique<zipfian_generator>(num_loaded, theta);
+    }
+    const uint64_t num_hot = std::max<uint64_t>(1, num_loaded / 5);
+
+    uint64_t num_present = num_loaded;
+    for (auto& op : trace) {
+        if (op.type == op_types::INSERT) {
+            op.key_id = num_present++;
+        } else if (spec.key_dist == "uniform") {
+            op.key_id = rnd.next_below(num_present);
+        } else if (spec.key_dist == "zipf") {
+            op.key_id = keygen::mix(seed, zipf->next(rnd)) % num_loaded;
+        } else if (spec.key_dist == "hotspot") {
+            // all are hot while the keys are too few to have cold ones
+            const bool hot = rnd.next_below(100) < 80 or num_present <= num_hot;
+            op.key_id = hot ? rnd.next_below(num_hot) : num_hot + rnd.next_below(num_present - num_hot);
+        } else if (spec.key_dist == "latest") {
+            op.key_id = num_present - 1 - zipf->next(rnd);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <size_t N>
+inline double get_average(const std::array<double, N>& ary) {
+    double sum = 0.0;
+    for (auto v : ary) {
+        sum += v;
+    }
+    return sum / N;
+}
+inline double get_average(const std::vector<double>& ary) {
+    double sum = 0.0;
+    for (auto v : ary) {
+        sum += v;
+    }
+    return sum / ary.size();
+}
+
+template <size_t N>
+inline double get_min(const std::array<double, N>& ary) {
+    double min = std::numeric_limits<double>::max();
+    for (auto v : ary) {
+        if (v < min) {
+            min = v;
+        }
+    }
+    return min;
+}
+inline double get_min(const std::vector<double>& ary) {
+    double min = std::numeric_limits<double>::max();
+    for (auto v : ary) {
+        if (v < min) {
+            min = v;
+        }
+    }
+    return min;
+}
+
+template <typename T>
+inline std::string realname() {
+    int status;
+    return abi::__cxa_demangle(typeid(T).name(), nullptr, nullptr, &status);
+}
+
+/**
+ *  Optional capabilities of wrappers
+ */
+// size_t search_batch(const std::string_view* keys, size_t num, bool* results)
+template <class Wrapper, class = void>
+struct has_search_batch : std::false_type {};
+template <class Wrapper>
+struct has_search_batch<Wrapper, std::void_t<decltype(std::declval<Wrapper&>().search_batch(
+                                     std::declval<const std::string_view*>(), size_t(0), std::declval<bool*>()))>>
+    : std::true_type {};
+
+// bool erase(std::string_view key)
+template <class Wrapper, class = void>
+struct has_erase : std::false_type {};
+template <class Wrapper>
+struct has_erase<Wrapper, std::void_t<decltype(std::declval<Wrapper&>().erase(std::declval<std::string_view>()))>>
+    : std::true_type {};
+
+// size_t prefix_search(std::string_view prefix, size_t limit)
+// Enumerates the keys starting with prefix, up to limit, and returns the # of them.
+template <class Wrapper, class = void>
+struct has_prefix_search : std::false_type {};
+template <class Wrapper>
+struct has_prefix_search<Wrapper, std::void_t<decltype(std::declval<Wrapper&>().prefix_search(
+                                      std::declval<std::string_view>(), size_t(0)))>> : std::true_type {};
+
+// bool save(const std::string& fn) and bool load(const std::string& fn)
+// load() restores the dictionary saved by save() into a wrapper just constructed.
+template <class Wrapper, class = void>
+struct has_save_load : std::false_type {};
+template <class Wrapper>
+struct has_save_load<Wrapper, std::void_t<decltype(std::declval<Wrapper&>().save(std::declval<const std::string&>())),
+                                          decltype(std::declval<Wrapper&>().load(std::declval<const std::string&>()))>>
+    : std::true_type {};
+
+// void reserve(size_t num_keys)
+// Pre-sizes the dictionary just constructed for num_keys keys with its native mechanism.
+template <class Wrapper, class = void>
+struct has_reserve : std::false_type {};
+template <class Wrapper>
+struct has_reserve<Wrapper, std::void_t<decltype(std::declval<Wrapper&>().reserve(size_t(0)))>> : std::true_type {};
+
+// size_t capacity() const
+// Capacity of the underlying table (e.g., # of buckets); a change of it on insertion is a growth event.
+template <class Wrapper, class = void>
+struct has_capacity : std::false_type {};
+template <class Wrapper>
+struct has_capacity<Wrapper, std::void_t<decltype(std::declval<const Wrapper&>().capacity())>> : std::true_type {};
+
+// size_t range_scan(std::string_view lo, std::string_view hi, size_t limit)
+// Enumerates the keys in [lo, hi) in lexicographic order, up to limit, and returns the # of them.
+// An empty hi means no upper bound.
+template <class Wrapper, class = void>
+struct has_range_scan : std::false_type {};
+template <class Wrapper>
+struct has_range_scan<Wrapper, std::void_t<decltype(std::declval<Wrapper&>().range_scan(
+                                   std::declval<std::string_view>(), std::declval<std::string_view>(), size_t(0)))>>
+    : std::true_type {};
+
+// The longest common prefix of the bounds, from which a trie scans a range; empty if hi is unbounded.
+inline std::string_view range_prefix(std::string_view lo, std::string_view hi) {
+    const size_t len = std::min(lo.size(), hi.size());
+    return lo.substr(0, std::mismatch(lo.begin(), lo.begin() + len, hi.begin()).first - lo.begin());
+}
+
+// size_t common_prefix_search(std::string_view text)
+// Returns the # of keys that are prefixes of text.
+template <class Wrapper, class = void>
+struct has_common_prefix_search : std::false_type {};
+template <class Wrapper>
+struct has_common_prefix_search<Wrapper, std::void_t<decltype(std::declval<Wrapper&>().common_prefix_search(
+                                             std::declval<std::string_view>()))>> : std::true_type {};
+
+// size_t longest_prefix(std::string_view text)
+// Returns the length of the longest key that is a prefix of text, or 0 if there is none.
+template <class Wrapper, class = void>
+struct has_longest_prefix : std::false_type {};
+template <class Wrapper>
+struct has_longest_prefix<Wrapper, std::void_t<decltype(std::declval<Wrapper&>().longest_prefix(
+                                       std::declval<std::string_view>()))>> : std::true_type {};
+
+// static constexpr bool lookup_by_string = true;
+// Declared by a wrapper whose dictionary looks up only std::string keys, which it would otherwise copy from each
+// std::string_view. The timed loops then pass it queries materialized as std::string before the timed region.
+template <class Wrapper, class = void>
+struct lookup_key {
+    using type = std::string_view;
+};
+template <class Wrapper>
+struct lookup_key<Wrapper, std::enable_if_t<Wrapper::lookup_by_string>> {
+    using type = std::string;
+};
+template <class Wrapper>
+using lookup_key_t = typename lookup_key<Wrapper>::type;
+
+template <class Wrapper, class Iterator>
+inline std::vector<lookup_key_t<Wrapper>> make_lookup_keys(Iterator beg, Iterator end) {
+    return std::vector<lookup_key_t<Wrapper>>(beg, end);
+}
+
+// Searches num keys, writes whether each is found, and returns the # of found keys.
+template <class Wrapper, class Key>
+inline size_t search_batch(Wrapper& wrapper, const Key* keys, size_t num, bool* results) {
+    if constexpr (has_search_batch<Wrapper>::value and std::is_same_v<Key, std::string_view>) {
+        return wrapper.search_batch(keys, num, results);
+    } else {
+        size_t ok = 0;
+        for (size_t i = 0; i < num; ++i) {
+            results[i] = wrapper.search(keys[i]);
+            ok += results[i];
+        }
+        return ok;
+    }
+}
+
+/**
+ *  Values
+ */
+// Opaque value of Bytes bytes, modeling 8-byte offsets and larger structs mapped from the keys. As for int,
+// payload(1) is what the wrappers store and payload(0) is what Poplar initializes a new slot with.
+template <size_t Bytes>
+struct payload {
+    std::array<uint8_t, Bytes> bytes;
+
+    explicit payload(int v = 0) {
+        bytes.fill(static_cast<uint8_t>(v));
+    }
+    bool operator==(const payload& rhs) const {
+        return bytes == rhs.bytes;
+    }
+};
+
+// appended to the wrapper names; none for the default int
+template <class Value>
+inline std::string value_suffix() {
+    if constexpr (std::is_same_v<Value, int>) {
+        return "";
+    } else {
+        return "_v" + std::to_string(sizeof(Value));
+    }
+}
+
+/**
+ *  STL and Google
+ */
+enum class standard_map_types { STD_MAP, STD_HASH, GOOGLE_DENCE_HASH, GOOGLE_SPARSE_HASH, SPP };
+
+template <standard_map_types, class Value>
+struct standard_map_trait;
+
+template <class Value>
+struct standard_map_trait<standard_map_types::STD_MAP, Value> {
+    using type = std::map<std::string, Value, std::less<>>;
+    static std::string name() {
+        return "std_map";
+    }
+};
+template <class Value>
+struct standard_map_trait<standard_map_types::STD_HASH, Value> {
+    using type = std::unordered_map<std::string, Value>;
+    static std::string name() {
+        return "std_unordered_map";
+    }
+};
+template <class Value>
+struct standard_map_trait<standard_map_types::GOOGLE_DENCE_HASH, Value> {
+    using type = google::dense_hash_map<std::string, Value>;
+    static std::string name() {
+        return "google_dense_hash_map";
+    }
+};
+template <class Value>
+struct standard_map_trait<standard_map_types::GOOGLE_SPARSE_HASH, Value> {
+    using type = google::sparse_hash_map<std::string, Value>;
+    static std::string name() {
+        return "google_sparse_hash_map";
+    }
+};
+template <class Value>
+struct standard_map_trait<standard_map_types::SPP, Value> {
+    using type = spp::sparse_hash_map<std::string, Value>;
+    static std::string name() {
+        return "sparsepp";
+    }
+};
+
+template <standard_map_types T, class Value = int>
+class standard_map_wrapper {
+  public:
+    explicit standard_map_wrapper(const std::vector<std::string>&) {
+        if constexpr (T == standard_map_types::GOOGLE_DENCE_HASH) {
+            dict_.set_empty_key("");
+        }
+        if constexpr ((T == standard_map_types::GOOGLE_DENCE_HASH) or (T == standard_map_types::GOOGLE_SPARSE_HASH)) {
+            dict_.set_deleted_key("\n");  // never appears in lines
+        }
+    }
+
+    // no heterogeneous lookup for the hash maps in C++17
+    static constexpr bool lookup_by_string = T != standard_map_types::STD_MAP;
+
+    static std::string name() {
+        return standard_map_trait<T, Value>::name() + value_suffix<Value>();
+    }
+    bool insert(std::string_view key) {
+        return dict_.insert(std::make_pair(std::string(key), Value(1))).second;
+    }
+    // Key is std::string_view or std::string (lookup_by_string)
+    template <class Key>
+    bool search(const Key& key) {
+        return find_(key) != dict_.end();
+    }
+    template <class Key>
+    bool update(const Key& key) {
+        auto it = find_(key);
+        if (it == dict_.end()) {
+            return false;
+        }
+        it->second = Value(1);
+        return true;
+    }
+    template <class Key>
+    bool erase(const Key& key) {
+        auto it = find_(key);
+        if (it == dict_.end()) {
+            return false;
+        }
+        dict_.erase(it);
+        return true;
+    }
+    template <standard_map_types U = T, typename = std::enable_if_t<U == standard_map_types::STD_MAP>>
+    size_t prefix_search(std::string_view prefix, size_t limit) {
+        size_t num = 0;
+        for (auto it = dict_.lower_bound(prefix);
+             it != dict_.end() and num < limit and it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+            ++num;
+        }
+        return num;
+    }
+    template <standard_map_types U = T, typename = std::enable_if_t<U != standard_map_types::STD_MAP>>
+    void reserve(size_t num_keys) {
+        if constexpr ((T == standard_map_types::GOOGLE_DENCE_HASH) or (T == standard_map_types::GOOGLE_SPARSE_HASH)) {
+            dict_.resize(num_keys);
+        } else {
+            dict_.reserve(num_keys);
+        }
+    }
+    template <standard_map_types U = T, typename = std::enable_if_t<U != standard_map_types::STD_MAP>>
+    size_t capacity() const {
+        return dict_.bucket_count();
+    }
+    template <standard_map_types U = T, typename = std::enable_if_t<U == standard_map_types::SPP>>
+    bool save(const std::string& fn) {
+        FILE* fp = std::fopen(fn.c_str(), "wb");
+        if (fp == nullptr) {
+            return false;
+        }
+        const bool ret = dict_.serialize(pair_serializer{}, fp);
+        return std::fclose(fp) == 0 and ret;
+    }
+    template <standard_map_types U = T, typename = std::enable_if_t<U == standard_map_types::SPP>>
+    bool load(const std::string& fn) {
+        FILE* fp = std::fopen(fn.c_str(), "rb");
+        if (fp == nullptr) {
+            return false;
+        }
+        const bool ret = dict_.unserialize(pair_serializer{}, fp);
+        std::fclose(fp);
+        return ret;
+    }
+    template <standard_map_types U = T, typename = std::enable_if_t<U == standard_map_types::STD_MAP>>
+    size_t range_scan(std::string_view lo, std::string_view hi, size_t limit) {
+        size_t num = 0;
+        for (auto it = dict_.lower_bound(lo); it != dict_.end() and num < limit and (hi.empty() or it->first < hi);
+             ++it) {
+            ++num;
+        }
+        return num;
+    }
+    void show_stat(std::ostream& os) const {}
+
+  private:
+    typename standard_map_trait<T, Value>::type dict_;
+
+    // (key length, key, value) for serialize(); unserialize() hands raw memory to be constructed in place
+    struct pair_serializer {
+        using value_type = typename standard_map_trait<T, Value>::type::value_type;
+        using mapped_type = typename standard_map_trait<T, Value>::type::mapped_type;
+
+        bool operator()(FILE* fp, const value_type& kv) const {
+            const uint32_t size = static_cast<uint32_t>(kv.first.size());
+            return std::fwrite(&size, sizeof(size), 1, fp) == 1 and
+                   std::fwrite(kv.first.data(), 1, size, fp) == size and
+                   std::fwrite(&kv.second, sizeof(mapped_type), 1, fp) == 1;
+        }
+        bool operator()(FILE* fp, value_type* kv) const {
+            uint32_t size = 0;
+            if (std::fread(&size, sizeof(size), 1, fp) != 1) {
+                return false;
+            }
+            std::string key(size, '\0');
+            mapped_type value{};
+            if (std::fread(&key[0], 1, size, fp) != size or std::fread(&value, sizeof(mapped_type), 1, fp) != 1) {
+                new (kv) value_type();  // to be destructible
+                return false;
+            }
+            new (kv) value_type(std::move(key), value);
+            return true;
+        }
+    };
+
+    auto find_(const std::string& key) {
+        return dict_.find(key);
+    }
+    auto find_(std::string_view key) {
+        if constexpr (T == standard_map_types::STD_MAP) {
+            return dict_.find(key);
+        } else {
+            return dict_.find(std::string(key));  // only where the queries are not materialized
+        }
+    }
+};
+
+/**
+ *  Tessil impl.
+ */
+// Transparent functors to look up std::string keys with std::string_view.
+struct string_view_hash {
+    using is_transparent = void;
+    size_t operator()(std::string_view key) const {
+        return std::hash<std::string_view>()(key);
+    }
+};
+struct string_view_equal {
+    using is_transparent = void;
+    bool operator()(std::string_view lhs, std::string_view rhs) const {
+        return lhs == rhs;
+    }
+};
+
+enum class tsl_map_types { ARRAY_HASH, HAT_TRIE, HOPSCOTCH, ROBIN };
+
+template <tsl_map_types, class Value>
+struct tsl_map_trait;
+
+template <class Value>
+struct tsl_map_trait<tsl_map_types::ARRAY_HASH, Value> {
+    using type = tsl::array_map<char, Value>;
+    static std::string name() {
+        return "tsl_array_hash";
+    }
+};
+template <class Value>
+struct tsl_map_trait<tsl_map_types::HAT_TRIE, Value> {
+    using type = tsl::htrie_map<char, Value>;
+    static std::string name() {
+        return "tsl_hat_trie";
+    }
+};
+template <class Value>
+struct tsl_map_trait<tsl_map_types::HOPSCOTCH, Value> {
+    using type = tsl::hopscotch_map<std::string, Value, string_view_hash, string_view_equal>;
+    static std::string name() {
+        return "tsl_hopscotch_map";
+    }
+};
+template <class Value>
+struct tsl_map_trait<tsl_map_types::ROBIN, Value> {
+    using type = tsl::robin_map<std::string, Value, string_view_hash, string_view_equal>;
+    static std::string name() {
+        return "tsl_robin_map";
+    }
+};
+
+template <tsl_map_types T, class Value = int>
+class tsl_map_wrapper {
+  public:
+    explicit tsl_map_wrapper(const std::vector<std::string>&) {}
+
+    static std::string name() {
+        return tsl_map_trait<T, Value>::name() + value_suffix<Value>();
+    }
+    bool insert(std::string_view key) {
+        if constexpr ((T == tsl_map_types::ARRAY_HASH) or (T == tsl_map_types::HAT_TRIE)) {
+            return dict_.insert_ks(key.data(), key.size(), Value(1)).second;
+        } else {
+            return dict_.insert({std::string(key), Value(1)}).second;
+        }
+    }
+    bool search(std::string_view key) {
+        return find_(key) != dict_.end();
+    }
+    bool update(std::string_view key) {
+        auto it = find_(key);
+        if (it == dict_.end()) {
+            return false;
+        }
+        it.value() = Value(1);
+        return true;
+    }
+    bool erase(std::string_view key) {
+        if constexpr ((T == tsl_map_types::ARRAY_HASH) or (T == tsl_map_types::HAT_TRIE)) {
+            return dict_.erase_ks(key.data(), key.size()) != 0;
+        } else {
+            return dict_.erase(key) != 0;
+        }
+    }
+    // the hash nodes of htrie burst locally and it has no table to grow
+    template <tsl_map_types U = T, typename = std::enable_if_t<U != tsl_map_types::HAT_TRIE>>
+    void reserve(size_t num_keys) {
+        dict_.reserve(num_keys);
+    }
+    template <tsl_map_types U = T, typename = std::enable_if_t<U != tsl_map_types::HAT_TRIE>>
+    size_t capacity() const {
+        return dict_.bucket_count();
+    }
+    template <tsl_map_types U = T, typename = std::enable_if_t<U == tsl_map_types::HAT_TRIE>>
+    size_t prefix_search(std::string_view prefix, size_t limit) {
+        auto range = dict_.equal_prefix_range_ks(prefix.data(), prefix.size());
+        size_t num = 0;
+        for (auto it = range.first; it != range.second and num < limit; ++it) {
+            ++num;
+        }
+        return num;
+    }
+    // the length is known only by restoring the key
+    template <tsl_map_types U = T, typename = std::enable_if_t<U == tsl_map_types::HAT_TRIE>>
+    size_t longest_prefix(std::string_view text) {
+        auto it = dict_.longest_prefix_ks(text.data(), text.size());
+        if (it == dict_.end()) {
+            return 0;
+        }
+        static thread_local std::string buf;
+        it.key(buf);
+        return buf.size();
+    }
+    void show_stat(std::ostream& os) const {}
+
+  private:
+    typename tsl_map_trait<T, Value>::type dict_;
+
+    auto find_(std::string_view key) {
+        if constexpr ((T == tsl_map_types::ARRAY_HASH) or (T == tsl_map_types::HAT_TRIE)) {
+            return dict_.find_ks(key.data(), key.size());
+        } else {
+            return dict_.find(key);
+        }
+    }
+};
+
+/**
+ *  Judy
+ */
+class judy_wrapper {
+  public:
+    explicit judy_wrapper(const std::vector<std::string>&) {}
+
+    ~judy_wrapper() {
+        Word_t bytes = 0;
+        JSLFA(bytes, dic_);
+    }
+    static std::string name() {
+        return "judySL";
+    }
+    // keys are terminated by '\0' (see key_arena)
+    bool insert(std::string_view key) {
+        Pvoid_t ptr = nullptr;
+        JSLI(ptr, dic_, reinterpret_cast<const uint8_t*>(key.data()));
+        auto p_word = reinterpret_cast<PWord_t>(ptr);
+        *p_word = 1;
+        max_length_ = std::max(max_length_, key.length());
+        return true;
+    }
+    bool search(std::string_view key) {
+        Pvoid_t ptr = nullptr;
+        JSLG(ptr, dic_, reinterpret_cast<const uint8_t*>(key.data()));
+        auto p_word = reinterpret_cast<PWord_t>(ptr);
+        return p_word != nullptr and *p_word == 1;
+    }
+    bool update(std::string_view key) {
+        Pvoid_t ptr = nullptr;
+        JSLG(ptr, dic_, reinterpret_cast<const uint8_t*>(key.data()));
+        if (ptr == nullptr) {
+            return false;
+        }
+        *reinterpret_cast<PWord_t>(ptr) = 1;
+        return true;
+    }
+    bool erase(std::string_view key) {
+        int rc = 0;
+        JSLD(rc, dic_, reinterpret_cast<const uint8_t*>(key.data()));
+        return rc == 1;
+    }
+    size_t prefix_search(std::string_view prefix, size_t limit) {
+        size_t num = 0;
+        for (Pvoid_t ptr = first_(prefix);
+             ptr != nullptr and num < limit and index_().substr(0, prefix.size()) == prefix; ptr = next_()) {
+            ++num;
+        }
+        return num;
+    }
+    size_t range_scan(std::string_view lo, std::string_view hi, size_t limit) {
+        size_t num = 0;
+        for (Pvoid_t ptr = first_(lo); ptr != nullptr and num < limit and (hi.empty() or index_() < hi);
+             ptr = next_()) {
+            ++num;
+        }
+        return num;
+    }
+    void show_stat(std::ostream& os) const {}
+
+  private:
+    Pvoid_t dic_ = nullptr;
+    size_t max_length_ = 0;
+    std::vector<uint8_t> index_buf_;
+
+    // JSLF/JSLN write the found key to the index buffer, which is thus as long as the longest key
+    Pvoid_t first_(std::string_view key) {
+        index_buf_.resize(std::max(max_length_, key.length()) + 1);
+        std::copy(key.begin(), key.end(), index_buf_.begin());
+        index_buf_[key.length()] = '\0';
+        Pvoid_t ptr = nullptr;
+        JSLF(ptr, dic_, index_buf_.data());
+        return ptr;
+    }
+    Pvoid_t next_() {
+        Pvoid_t ptr = nullptr;
+        JSLN(ptr, dic_, index_buf_.data());
+        return ptr;
+    }
+    std::string_view index_() const {
+        return reinterpret_cast<const char*>(index_buf_.data());
+    }
+};
+
+/**
+ *  ART
+ */
+class art_wrapper {
+  public:
+    explicit art_wrapper(const std::vector<std::string>&) {
+        art_tree_init(&dict_);
+    }
+    ~art_wrapper() {
+        destroy_art_tree(&dict_);
+    }
+    static std::string name() {
+        return "art";
+    }
+    // keys are terminated by '\0' (see key_arena)
+    bool insert(std::string_view key) {
+        uintptr_t value = 1;
+        return art_insert(&dict_, reinterpret_cast<const unsigned char*>(key.data()),
+                          static_cast<int>(key.length() + 1),  // with terminator
+                          reinterpret_cast<void*>(value)) == nullptr;
+    }
+    bool search(std::string_view key) {
+        return reinterpret_cast<uintptr_t>(art_search(&dict_, reinterpret_cast<const unsigned char*>(key.data()),
+                                                      static_cast<int>(key.length()) + 1  // with terminator
+                                                      )) == 1;
+    }
+    // art_insert() overwrites the value of an existing key in place
+    bool update(std::string_view key) {
+        return !insert(key);
+    }
+    bool erase(std::string_view key) {
+        return art_delete(&dict_, reinterpret_cast<const unsigned char*>(key.data()),
+                          static_cast<int>(key.length()) + 1  // with terminator
+                          ) != nullptr;
+    }
+    size_t prefix_search(std::string_view prefix, size_t limit) {
+        std::pair<size_t, size_t> num_limit(0, limit);
+        if (limit != 0) {
+            art_iter_prefix(&dict_, reinterpret_cast<const unsigned char*>(prefix.data()),
+                            static_cast<int>(prefix.length()),
+                            [](void* data, const unsigned char*, uint32_t, void*) -> int {
+                                auto p = static_cast<std::pair<size_t, size_t>*>(data);
+                                return ++p->first == p->second;  // stops at the limit
+                            },
+                            &num_limit);
+        }
+        return num_limit.first;
+    }
+    // libart sorts the children of Node16 by signed bytes on x86 (see add_child16()) and does not re-sort those
+    // copied from Node4, so art_iter() is not in lexicographic order. The scan instead descends by itself,
+    // visiting the children of Node4 and Node16 sorted by unsigned bytes and skipping the subtrees before lo.
+    size_t range_scan(std::string_view lo, std::string_view hi, size_t limit) {
+        scan_state state{lo, hi, 0, limit};
+        if (limit != 0 and dict_.root != nullptr) {
+            scan_(dict_.root, 0, true, state);
+        }
+        return state.num;
+    }
+    size_t common_prefix_search(std::string_view text) const {
+        size_t num = 0;
+        walk_prefixes_(text, [&](size_t) { ++num; });
+        return num;
+    }
+    size_t longest_prefix(std::string_view text) const {
+        size_t len = 0;
+        walk_prefixes_(text, [&](size_t l) { len = l; });
+        return len;
+    }
+    void show_stat(std::ostream& os) const {}
+
+  private:
+    art_tree dict_;
+
+    // libart has no common prefix search; these walk its nodes as art_search() does (see art.c)
+    static bool is_leaf_(const art_node* n) {
+        return reinterpret_cast<uintptr_t>(n) & 1;
+    }
+    static const art_leaf* leaf_raw_(const art_node* n) {
+        return reinterpret_cast<const art_leaf*>(reinterpret_cast<uintptr_t>(n) & ~uintptr_t(1));
+    }
+    static const art_node* find_child_(const art_node* n, unsigned char c) {
+        switch (n->type) {
+            case NODE4: {
+                auto p = reinterpret_cast<const art_node4*>(n);
+                for (int i = 0; i < n->num_children; ++i) {
+                    if (p->keys[i] == c) {
+                        return p->children[i];
+                    }
+                }
+                break;
+            }
+            case NODE16: {
+                auto p = reinterpret_cast<const art_node16*>(n);
+                for (int i = 0; i < n->num_children; ++i) {
+                    if (p->keys[i] == c) {
+                        return p->children[i];
+                    }
+                }
+                break;
+            }
+            case NODE48: {
+                auto p = reinterpret_cast<const art_node48*>(n);
+                return p->keys[c] != 0 ? p->children[p->keys[c] - 1] : nullptr;
+            }
+            case NODE256:
+                return reinterpret_cast<const art_node256*>(n)->children[c];
+        }
+        return nullptr;
+    }
+    // Returns a leaf below n, from which a compressed path longer than MAX_PREFIX_LEN is read (see minimum()).
+    static const art_leaf* any_leaf_(const art_node* n) {
+        while (!is_leaf_(n)) {
+            switch (n->type) {
+                case NODE4:
+                    n = reinterpret_cast<const art_node4*>(n)->children[0];
+                    break;
+                case NODE16:
+                    n = reinterpret_cast<const art_node16*>(n)->children[0];
+                    break;
+                case NODE48: {
+                    auto p = reinterpret_cast<const art_node48*>(n);
+                    int c = 0;
+                    while (p->keys[c] == 0) {
+                        ++c;
+                    }
+                    n = p->children[p->keys[c] - 1];
+                    break;
+                }
+                case NODE256: {
+                    auto p = reinterpret_cast<const art_node256*>(n);
+                    int c = 0;
+                    while (p->children[c] == nullptr) {
+                        ++c;
+                    }
+                    n = p->children[c];
+                    break;
+                }
+            }
+        }
+        return leaf_raw_(n);
+    }
+
+    struct scan_state {
+        std::string_view lo, hi;
+        size_t num, limit;
+    };
+    // Enumerates the keys in [lo, hi) below n at depth in lexicographic order, where bounded means that the path
+    // to n equals the first depth bytes of lo. Returns false once the scan has reached hi or the limit.
+    static bool scan_(const art_node* n, size_t depth, bool bounded, scan_state& s) {
+        if (is_leaf_(n)) {
+            const art_leaf* l = leaf_raw_(n);
+            std::string_view key(reinterpret_cast<const char*>(l->key), l->key_len - 1);  // without terminator
+            if (bounded and key < s.lo) {
+                return true;
+            }
+            if (!s.hi.empty() and key >= s.hi) {
+                return false;
+            }
+            return ++s.num < s.limit;
+        }
+
+        // byte i of lo followed by the terminator, as the keys are stored
+        auto lo_at = [&](size_t i) -> int {
+            return i < s.lo.size() ? static_cast<unsigned char>(s.lo[i]) : (i == s.lo.size() ? 0 : -1);
+        };
+        if (bounded and n->partial_len != 0) {
+            const art_leaf* l = n->partial_len > MAX_PREFIX_LEN ? any_leaf_(n) : nullptr;
+            for (size_t i = 0; i < n->partial_len; ++i) {
+                const int c = l != nullptr ? l->key[depth + i] : n->partial[i];
+                const int b = lo_at(depth + i);
+                if (c != b) {
+                    if (c < b) {
+                        return true;  // all the keys below are before lo
+                    }
+                    bounded = false;
+                    break;
+                }
+            }
+        }
+        depth += n->partial_len;
+
+        const int from = bounded ? std::max(lo_at(depth), 0) : 0;
+        auto visit = [&](int c, const art_node* child) {
+            return scan_(child, depth + 1, bounded and c == from, s);
+        };
+        switch (n->type) {
+            case NODE4:
+            case NODE16: {
+                const unsigned char* keys = n->type == NODE4 ? reinterpret_cast<const art_node4*>(n)->keys
+                                                             : reinterpret_cast<const art_node16*>(n)->keys;
+                art_node* const* children = n->type == NODE4 ? reinterpret_cast<const art_node4*>(n)->children
+                                                             : reinterpret_cast<const art_node16*>(n)->children;
+                std::array<std::pair<unsigned char, const art_node*>, 16> sorted;
+                for (int i = 0; i < n->num_children; ++i) {
+                    sorted[i] = {keys[i], children[i]};
+                }
+                std::sort(sorted.begin(), sorted.begin() + n->num_children,
+                          [](const auto& a, const auto& b) { return a.first < b.first; });
+                for (int i = 0; i < n->num_children; ++i) {
+                    if (sorted[i].first >= from and !visit(sorted[i].first, sorted[i].second)) {
+                        return false;
+                    }
+                }
+                break;
+            }
+            case NODE48: {
+                auto p = reinterpret_cast<const art_node48*>(n);
+                for (int c = from; c < 256; ++c) {
+                    if (p->keys[c] != 0 and !visit(c, p->children[p->keys[c] - 1])) {
+                        return false;
+                    }
+                }
+                break;
+            }
+            case NODE256: {
+                auto p = reinterpret_cast<const art_node256*>(n);
+                for (int c = from; c < 256; ++c) {
+                    if (p->children[c] != nullptr and !visit(c, p->children[c])) {
+                        return false;
+                    }
+                }
+                break;
+            }
+        }
+        return true;
+    }
+
+    // Calls on_match(len) in ascending order of len for every key of length len that is a prefix of text.
+    // As in art_search(), at most MAX_PREFIX_LEN bytes of the compressed paths are compared, so each match is
+    // verified against its leaf.
+    template <class F>
+    void walk_prefixes_(std::string_view text, F&& on_match) const {
+        auto matches = [&](const art_leaf* l) {
+            const size_t len = l->key_len - 1;  // without terminator
+            return len <= text.size() and std::memcmp(l->key, text.data(), len) == 0;
+        };
+
+        const art_node* n = dict_.root;
+        size_t depth = 0;
+        while (n != nullptr) {
+            if (is_leaf_(n)) {
+                if (matches(leaf_raw_(n))) {
+                    on_match(leaf_raw_(n)->key_len - 1);
+                }
+                return;
+            }
+            if (n->partial_len != 0) {
+                if (depth + n->partial_len > text.size()) {
+                    return;
+                }
+                const size_t len = std::min<size_t>(n->partial_len, MAX_PREFIX_LEN);
+                if (std::memcmp(n->partial, text.data() + depth, len) != 0) {
+                    return;
+                }
+                depth += n->partial_len;
+            }
+            // a key ending here is the leaf under the terminator
+            const art_node* child = find_child_(n, '\0');
+            if (child != nullptr and is_leaf_(child) and matches(leaf_raw_(child))) {
+                on_match(depth);
+            }
+            if (depth == text.size()) {
+                return;
+            }
+            n = find_child_(n, static_cast<unsigned char>(text[depth]));
+            depth += 1;
+        }
+    }
+};
+
+/**
+ *  Cedar
+ */
+enum class cedar_types { TRIE, MP_TRIE };
+
+// With Ordered, the siblings are kept sorted so that the keys are enumerated in lexicographic order.
+template <cedar_types, bool Ordered>
+struct cedar_wrapper_trait;
+template <bool Ordered>
+struct cedar_wrapper_trait<cedar_types::TRIE, Ordered> {
+    using type = cedar::da<int, -1, -2, Ordered>;
+    using npos_type = size_t;
+    static std::string name() {
+        return Ordered ? "cedar_ordered" : "cedar";
+    }
+};
+template <bool Ordered>
+struct cedar_wrapper_trait<cedar_types::MP_TRIE, Ordered> {
+    using type = cedarpp::da<int, -1, -2, Ordered>;
+    using npos_type = cedarpp::npos_t;
+    static std::string name() {
+        return Ordered ? "cedarpp_ordered" : "cedarpp";
+    }
+};
+
+template <cedar_types T, bool Ordered = false>
+class cedar_wrapper {
+  public:
+    explicit cedar_wrapper(const std::vector<std::string>&) {}
+
+    static std::string name() {
+        return cedar_wrapper_trait<T, Ordered>::name();
+    }
+    bool insert(std::string_view key) {
+        dict_.update(key.data(), key.length()) = 1;
+        return true;
+    }
+    bool search(std::string_view key) {
+        return dict_.template exactMatchSearch<int>(key.data(), key.length()) == 1;
+    }
+    bool update(std::string_view key) {
+        return insert(key);
+    }
+    // cedar erases without compaction; the freed nodes are reused by later insertions
+    bool erase(std::string_view key) {
+        return dict_.erase(key.data(), key.length()) == 0;
+    }
+    // as commonPrefixPredict(), which however visits all the completions regardless of the limit
+    size_t prefix_search(std::string_view prefix, size_t limit) {
+        using dict_type = typename cedar_wrapper_trait<T, Ordered>::type;
+        using npos_type = typename cedar_wrapper_trait<T, Ordered>::npos_type;
+
+        npos_type from = 0;
+        size_t pos = 0;
+        if (dict_.traverse(prefix.data(), from, pos, prefix.length()) == dict_type::CEDAR_NO_PATH) {
+            return 0;
+        }
+        const npos_type root = from;
+        size_t num = 0, len = 0;
+        for (int v = dict_.begin(from, len); v != dict_type::CEDAR_NO_PATH and num < limit;
+             v = dict_.next(from, len, root)) {
+            ++num;
+        }
+        return num;
+    }
+    size_t capacity() const {
+        return dict_.capacity();
+    }
+    bool save(const std::string& fn) const {
+        return dict_.save(fn.c_str()) == 0;
+    }
+    bool load(const std::string& fn) {
+        return dict_.open(fn.c_str()) == 0;
+    }
+    // Seeks lo in the subtrie of the common prefix of the bounds and enumerates from there, restoring the keys
+    // to compare them with hi.
+    template <bool O = Ordered, typename = std::enable_if_t<O>>
+    size_t range_scan(std::string_view lo, std::string_view hi, size_t limit) {
+        using dict_type = typename cedar_wrapper_trait<T, Ordered>::type;
+        using npos_type = typename cedar_wrapper_trait<T, Ordered>::npos_type;
+
+        const std::string_view prefix = range_prefix(lo, hi);
+        npos_type from = 0;
+        size_t pos = 0;
+        if (!prefix.empty() and
+            dict_.traverse(prefix.data(), from, pos, prefix.length()) == dict_type::CEDAR_NO_PATH) {
+            return 0;
+        }
+        static thread_local std::string buf;
+        buf.assign(prefix.data(), prefix.size());
+
+        const npos_type root = from;
+        size_t num = 0, len = 0;
+        int v = lo.size() > prefix.size() ? seek_(lo.substr(prefix.size()), from, len) : dict_.begin(from, len);
+        for (; v != dict_type::CEDAR_NO_PATH and num < limit; v = dict_.next(from, len, root)) {
+            if (!hi.empty()) {
+                buf.resize(prefix.size() + len + 1);  // suffix() appends '\0'
+                dict_.suffix(&buf[prefix.size()], len, from);
+                if (std::string_view(buf.data(), prefix.size() + len) >= hi) {
+                    break;
+                }
+            }
+            ++num;
+        }
+        return num;
+    }
+    size_t common_prefix_search(std::string_view text) const {
+        size_t num = 0;
+        walk_prefixes_(text, [&](size_t) { ++num; });
+        return num;
+    }
+    size_t longest_prefix(std::string_view text) const {
+        size_t len = 0;
+        walk_prefixes_(text, [&](size_t l) { len = l; });
+        return len;
+    }
+    void show_stat(std::ostream& os) const {
+        os << "capacity:" << dict_.capacity() << "\n";
+        os << "size:" << dict_.size() << "\n";
+        if constexpr (T == cedar_types::MP_TRIE) {
+            os << "length:" << dict_.length() << "\n";
+        }
+        os << "total_size:" << dict_.total_size() << "\n";
+        os << "unit_size:" << dict_.unit_size() << "\n";
+        os << "nonzero_size:" << dict_.nonzero_size() << "\n";
+        if constexpr (T == cedar_types::MP_TRIE) {
+            os << "nonzero_length:" << dict_.nonzero_length() << "\n";
+        }
+        os << "num_keys:" << dict_.num_keys() << "\n";
+    }
+
+  private:
+    typename cedar_wrapper_trait<T, Ordered>::type dict_;
+
+    // As begin(), but moves from to the first key in its subtrie not less than the path to from followed by rest.
+    // cedar exposes no sibling links, so the least label greater than that of rest at a node is found by probing
+    // the labels in ascending order with traverse().
+    template <bool O = Ordered, typename = std::enable_if_t<O>>
+    int seek_(std::string_view rest, typename cedar_wrapper_trait<T, Ordered>::npos_type& from, size_t& len) {
+        using dict_type = typename cedar_wrapper_trait<T, Ordered>::type;
+        using npos_type = typename cedar_wrapper_trait<T, Ordered>::npos_type;
+
+        static thread_local std::vector<npos_type> path;  // path[d] is the node at depth d below from
+        path.assign(1, from);
+        size_t depth = 0;
+        for (; depth < rest.size(); ++depth) {
+            npos_type to = from;
+            size_t pos = depth;
+            if (dict_.traverse(rest.data(), to, pos, depth + 1) == dict_type::CEDAR_NO_PATH) {
+                break;
+            }
+            path.push_back(from = to);
+        }
+        if (depth == rest.size()) {
+            len = depth;
+            return dict_.begin(from, len);
+        }
+        // the keys under path[depth] with the label rest[depth] would follow; continue from the next sibling of
+        // the deepest node having one
+        for (size_t d = depth + 1; d-- > 0;) {
+            for (int c = static_cast<uint8_t>(rest[d]) + 1; c < 256; ++c) {
+                const char label = static_cast<char>(c);
+                npos_type to = path[d];
+                size_t pos = 0;
+                if (dict_.traverse(&label, to, pos, 1) != dict_type::CEDAR_NO_PATH) {
+                    from = to;
+                    len = d + 1;
+                    return dict_.begin(from, len);
+                }
+            }
+        }
+        return dict_type::CEDAR_NO_PATH;
+    }
+
+    // as commonPrefixSearch(), without the result buffer
+    template <class F>
+    void walk_prefixes_(std::string_view text, F&& on_match) const {
+        using dict_type = typename cedar_wrapper_trait<T, Ordered>::type;
+        typename cedar_wrapper_trait<T, Ordered>::npos_type from = 0;
+        for (size_t pos = 0; pos < text.size();) {
+            const int v = dict_.traverse(text.data(), from, pos, pos + 1);
+            if (v == dict_type::CEDAR_NO_VALUE) {
+                continue;
+            }
+            if (v == dict_type::CEDAR_NO_PATH) {
+                return;
+            }
+            on_match(pos);
+        }
+    }
+};
+
+/**
+ *  Poplar
+ */
+enum class poplar_types {
+    PLAIN_BONSAI,
+    SEMI_COMPACT_BONSAI,
+    COMPACT_BONSAI,
+    PLAIN_FKHASH,
+    SEMI_COMPACT_FKHASH,
+    COMPACT_FKHASH,
+};
+
+template <poplar_types, uint64_t ChunkSize, class Value>
+struct poplar_wrapper_trait;
+
+template <uint64_t ChunkSize, class Value>
+struct poplar_wrapper_trait<poplar_types::PLAIN_BONSAI, ChunkSize, Value> {
+    using type = poplar::plain_bonsai_map<Value>;
+    static std::string name() {
+        return "poplar_plain_bonsai (PDT-PB)";
+    }
+};
+template <uint64_t ChunkSize, class Value>
+struct poplar_wrapper_trait<poplar_types::SEMI_COMPACT_BONSAI, ChunkSize, Value> {
+    using type = poplar::semi_compact_bonsai_map<Value, ChunkSize>;
+    static std::string name() {
+        return "poplar_semi_compact_bonsai_" + std::to_string(ChunkSize) + " (PDT-SB)";
+    }
+};
+template <uint64_t ChunkSize, class Value>
+struct poplar_wrapper_trait<poplar_types::COMPACT_BONSAI, ChunkSize, Value> {
+    using type = poplar::compact_bonsai_map<Value, ChunkSize>;
+    static std::string name() {
+        return "poplar_compact_bonsai_" + std::to_string(ChunkSize) + " (PDT-CB)";
+    }
+};
+template <uint64_t ChunkSize, class Value>
+struct poplar_wrapper_trait<poplar_types::PLAIN_FKHASH, ChunkSize, Value> {
+    using type = poplar::plain_fkhash_map<Value>;
+    static std::string name() {
+        return "poplar_plain_fkhash (PDT-PFK)";
+    }
+};
+template <uint64_t ChunkSize, class Value>
+struct poplar_wrapper_trait<poplar_types::SEMI_COMPACT_FKHASH, ChunkSize, Value> {
+    using type = poplar::semi_compact_fkhash_map<Value, ChunkSize>;
+    static std::string name() {
+        return "poplar_semi_compact_fkhash_" + std::to_string(ChunkSize) + " (PDT-SFK)";
+    }
+};
+template <uint64_t ChunkSize, class Value>
+struct poplar_wrapper_trait<poplar_types::COMPACT_FKHASH, ChunkSize, Value> {
+    using type = poplar::compact_fkhash_map<Value, ChunkSize>;
+    static std::string name() {
+        return "poplar_compact_fkhash_" + std::to_string(ChunkSize) + " (PDT-CFK)";
+    }
+};
+
+template <poplar_types T, uint64_t ChunkSize = 0, class Value = int>
+class poplar_wrapper {
+  public:
+    explicit poplar_wrapper(const std::vector<std::string>& args) {
+        if (args.size() >= 2) {
+            uint32_t capa_bits = std::stoul(args[0]);
+            uint64_t lambda = std::stoul(args[1]);
+            dict_ = typename poplar_wrapper_trait<T, ChunkSize, Value>::type(capa_bits, lambda);
+            has_args_ = true;
+        }
+    }
+    // the suffix of the value goes before the abbreviation, e.g., "poplar_plain_bonsai_v8 (PDT-PB)"
+    static std::string name() {
+        std::string name = poplar_wrapper_trait<T, ChunkSize, Value>::name();
+        return name.insert(name.find(' '), value_suffix<Value>());
+    }
+    bool insert(std::string_view key) {
+        *dict_.update(make_char_range_(key)) = Value(1);
+        return true;
+    }
+    bool search(std::string_view key) {
+        auto ptr = dict_.find(make_char_range_(key));
+        return ptr != nullptr and *ptr == Value(1);
+    }
+    bool update(std::string_view key) {
+        return insert(key);
+    }
+    // The table holds the nodes of the path-decomposed trie, about one per key plus one per lambda bytes of a
+    // long label (< 1% more on jawiki, URLs and 120-byte keys sharing 80-byte prefixes), and expands once
+    // MaxFactor = 90% of it is used. It is thus sized for NODES_PER_KEY nodes at that load, and never below the
+    // minimum capacity, so that less than about 56k keys fit in the initial table anyway. capa_bits given as the
+    // arguments take precedence.
+    void reserve(size_t num_keys) {
+        static constexpr double NODES_PER_KEY = 1.05, MAX_FACTOR = 0.9;
+        using map_type = typename poplar_wrapper_trait<T, ChunkSize, Value>::type;
+        if (!has_args_) {
+            const uint64_t num_nodes = static_cast<uint64_t>(num_keys * NODES_PER_KEY / MAX_FACTOR) + 1;
+            dict_ = map_type(std::max<uint32_t>(map_type::min_capa_bits, poplar::bit_tools::ceil_log2(num_nodes)));
+        }
+    }
+    size_t capacity() const {
+        return dict_.capa_size();
+    }
+    void show_stat(std::ostream& os) const {
+        dict_.show_stats(os);
+    }
+
+  private:
+    typename poplar_wrapper_trait<T, ChunkSize, Value>::type dict_;
+    bool has_args_ = false;
+
+    // as poplar::make_char_range(), the range includes the terminator '\0' (see key_arena)
+    static poplar::char_range make_char_range_(std::string_view key) {
+        auto ptr = reinterpret_cast<const uint8_t*>(key.data());
+        return {ptr, ptr + (key.size() + 1)};
+    }
+};
+
+struct bench_options {
+    int runs = 10;
+    std::string key_fn;
+    std::string query_fn = "-";
+    std::vector<std::string> args;  // passed to the wrapper constructor
+    int threads = 0;
+    bool disjoint = false;
+    bool latency = false;
+    bool perf = false;
+    std::string workload;  // empty if disabled
+    std::string key_dist;  // overrides that of the workload if not empty
+    double zipf_theta = 0.99;
+    uint64_t num_ops = 0;  // 0 means # of keys
+    uint64_t seed = 0;
+    std::string negative;  // kind of absent queries; empty if disabled
+    double miss_ratio = 0.5;
+    std::string order = "file";  // of insertion
+    size_t cluster_bytes = 3;    // of the prefixes shared by the clusters of the clustered order
+    bool batch = false;
+    double erase_ratio = 0.0;  // 0 if disabled
+    size_t expected_keys = 0;  // for pre-sized builds; 0 if disabled
+    std::string save_fn;       // empty if disabled
+    std::string growth_trace;  // CSV file name of growth events; empty if disabled
+    int churn = 0;             // # of rounds; 0 if disabled
+    double churn_ratio = 0.1;  // of the resident keys replaced in a round
+    size_t prefix_len = 0;     // of the query prefixes; 0 if disabled
+    size_t prefix_limit = 0;   // max # of completions per prefix; 0 means all
+    std::string text_fn;       // text to be tokenized; empty if disabled
+    std::string match = "all";
+    int scan = -1;  // # of range scans; -1 if disabled
+    size_t scan_span = 100;
+    size_t scaling = 0;  // # of keys at the first checkpoint; 0 if disabled
+    size_t scaling_sample = 100000;
+    std::vector<std::string> loads;  // offered loads of the open-loop mode; empty if disabled
+    std::string arrival = "poisson";
+    int workers = 1;
+    bool stream = false;
+    std::string cache_state = "warm";
+    int pin_cpu = -1;    // first logical CPU of the benchmark threads; -1 if not pinned
+    int numa_node = -1;  // to which memory is bound; -1 if not bound
+    std::string thp = "default";
+};
+
+template <class Wrapper>
+int bench(const bench_options& opts) {
+    const int runs = opts.runs;
+    const std::string& key_fn = opts.key_fn;
+    const std::string& query_fn = opts.query_fn;
+    const std::vector<std::string>& args = opts.args;
+
+    std::shared_ptr<key_arena> keys;
+    std::shared_ptr<key_arena> queries;
+
+    alloc_tracker::phase load_heap, insert_heap, search_heap;
+    load_heap.start();
+
+    keys = std::make_shared<key_arena>();
+    if (!keys->load(key_fn)) {
+        std::cerr << "open error: key_fn = " << key_fn << std::endl;
+        return 1;
+    }
+
+    if (query_fn != "-") {
+        queries = std::make_shared<key_arena>();
+        if (!queries->load(query_fn)) {
+            std::cerr << "open error: query_fn = " << query_fn << std::endl;
+            return 1;
+        }
+    } else {
+        queries = keys;
+    }
+
+    std::vector<std::string_view> insert_keys(keys->begin(), keys->end());
+    if (!reorder_keys(insert_keys, opts.order, opts.seed, opts.cluster_bytes)) {
+        std::cerr << "error: invalid order = " << opts.order << std::endl;
+        return 1;
+    }
+    const auto lookup_queries = make_lookup_keys<Wrapper>(queries->begin(), queries->end());
+    load_heap.stop();
+
+    auto wrapper = std::make_unique<Wrapper>(args);
+
+    size_t num_keys = 0, num_queries = 0;
+    size_t ok = 0, ng = 0;
+    size_t process_size = get_process_size();
+    double constr_sec = 0.0;
+    double insert_us_per_key = 0.0, search_us_per_query = 0.0;
+    double best_insert_us_per_key = 0.0, best_search_us_per_query = 0.0;
+
+    {
+        timer t;
+        for (std::string_view key : insert_keys) {
+            wrapper->insert(key);
+        }
+        constr_sec = t.get<>();
+        process_size = get_process_size() - process_size;
+    }
+
+    std::unique_ptr<perf_counters> insert_perf, search_perf;
+    if (opts.perf) {
+        insert_perf = std::make_unique<perf_counters>();
+        search_perf = std::make_unique<perf_counters>();
+    }
+
+    {
+        std::vector<double> insert_times(runs);
+        std::vector<double> search_times(runs);
+
+        for (int i = 0; i < runs; ++i) {
+            wrapper.reset();
+            insert_heap.start();
+            wrapper = std::make_unique<Wrapper>(args);
+
+            // insertion
+            {
+                if (insert_perf) {
+                    insert_perf->start();
+                }
+                timer t;
+                for (std::string_view key : insert_keys) {
+                    wrapper->insert(key);
+                }
+                insert_times[i] = t.get<std::micro>() / keys->size();
+                if (insert_perf) {
+                    insert_perf->stop();
+                }
+            }
+            insert_heap.stop();
+
+            // retrieval
+            size_t _ok = 0, _ng = 0;
+            search_heap.start();
+            {
+                if (search_perf) {
+                    search_perf->start();
+                }
+                timer t;
+                for (const auto& query : lookup_queries) {
+                    if (wrapper->search(query)) {
+                        ++_ok;
+                    } else {
+                        ++_ng;
+                    }
+                }
+                search_times[i] = t.get<std::micro>() / queries->size();
+                if (search_perf) {
+                    search_perf->stop();
+                }
+            }
+            search_heap.stop();
+
+            if (i != 0) {
+                if ((ok != _ok) or (ng != _ng)) {
+                    std::cerr << "critical error for search results" << std::endl;
+                    return 1;
+                }
+            }
+
+            ok = _ok;
+            ng = _ng;
+        }
+
+        num_keys = keys->size();
+        num_queries = queries->size();
+        insert_us_per_key = get_average(insert_times);
+        best_insert_us_per_key = get_min(insert_times);
+        search_us_per_query = get_average(search_times);
+        best_search_us_per_query = get_min(search_times);
+    }
+
+    // Searches over the dictionary of the last run with cold caches, as when it has been evicted by other work:
+    // blocks of COLD_BLOCK consecutive queries from random positions, each block timed right after an eviction,
+    // and sampled queries each timed right after an eviction (cold) and once more (warm). Evictions are not timed.
+    static constexpr size_t COLD_BLOCK = 16, COLD_BLOCKS = 100, COLD_QUERIES = 1000;
+    size_t evict_bytes = 0, num_cold_block_queries = 0;
+    double cold_search_us_per_query = 0.0, best_cold_search_us_per_query = 0.0;
+    latency_histogram cold_query_hist, warm_query_hist;
+    if (opts.cache_state == "cold") {
+        cache_evictor evictor;
+        evict_bytes = evictor.size();
+
+        keygen::random rnd(opts.seed);
+        std::vector<std::pair<size_t, size_t>> blocks(COLD_BLOCKS);  // [beg, end) of the queries
+        size_t block_ok = 0;
+        for (auto& block : blocks) {
+            block.first = rnd.next_below(queries->size());
+            block.second = std::min(block.first + COLD_BLOCK, queries->size());
+            for (size_t j = block.first; j < block.second; ++j) {
+                block_ok += wrapper->search(lookup_queries[j]);
+            }
+            num_cold_block_queries += block.second - block.first;
+        }
+
+        std::vector<double> times(runs);
+        for (int i = 0; i < runs; ++i) {
+            size_t _ok = 0;
+            double us = 0.0;
+            for (const auto& block : blocks) {
+                evictor.evict();
+                timer t;
+                for (size_t j = block.first; j < block.second; ++j) {
+                    _ok += wrapper->search(lookup_queries[j]);
+                }
+                us += t.get<std::micro>();
+            }
+            times[i] = us / num_cold_block_queries;
+            if (_ok != block_ok) {
+                std::cerr << "critical error for search results with cold caches" << std::endl;
+                return 1;
+            }
+        }
+        cold_search_us_per_query = get_average(times);
+        best_cold_search_us_per_query = get_min(times);
+
+        const uint64_t overhead_ns = measure_timer_overhead();
+        auto elapsed_ns = [&](uint64_t beg, uint64_t end) {
+            return end - beg > overhead_ns ? end - beg - overhead_ns : 0;
+        };
+        for (size_t i = 0; i < COLD_QUERIES; ++i) {
+            const auto& query = lookup_queries[rnd.next_below(queries->size())];
+            evictor.evict();
+            uint64_t beg = now_ns();
+            wrapper->search(query);
+            cold_query_hist.record(elapsed_ns(beg, now_ns()));
+            beg = now_ns();
+            wrapper->search(query);
+            warm_query_hist.record(elapsed_ns(beg, now_ns()));
+        }
+    }
+
+    // Builds pre-sized for the # of keys expected, compared with the growing builds above
+    double presized_insert_us_per_key = 0.0, best_presized_insert_us_per_key = 0.0;
+    double presized_search_us_per_query = 0.0;
+    alloc_tracker::phase presized_heap;
+    if constexpr (has_reserve<Wrapper>::value) {
+        if (opts.expected_keys > 0) {
+            std::vector<double> times(runs);
+            std::unique_ptr<Wrapper> presized;
+            for (int i = 0; i < runs; ++i) {
+                presized.reset();
+                presized_heap.start();
+                presized = std::make_unique<Wrapper>(args);
+                timer t;
+                presized->reserve(opts.expected_keys);
+                for (std::string_view key : insert_keys) {
+                    presized->insert(key);
+                }
+                times[i] = t.get<std::micro>() / keys->size();
+                presized_heap.stop();
+            }
+            presized_insert_us_per_key = get_average(times);
+            best_presized_insert_us_per_key = get_min(times);
+
+            size_t _ok = 0;
+            timer t;
+            for (const auto& query : lookup_queries) {
+                _ok += presized->search(query);
+            }
+            presized_search_us_per_query = t.get<std::micro>() / queries->size();
+            if (_ok != ok) {
+                std::cerr << "critical error for search results of the pre-sized build" << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    // Batched retrieval over the dictionary of the last run
+    static constexpr std::array<size_t, 4> BATCH_SIZES = {1, 8, 16, 64};
+    std::array<double, BATCH_SIZES.size()> batch_us_per_query = {}, best_batch_us_per_query = {};
+    if (opts.batch) {
+        const auto& batch_queries = lookup_queries;
+        std::unique_ptr<bool[]> results = std::make_unique<bool[]>(BATCH_SIZES.back());
+
+        for (size_t b = 0; b < BATCH_SIZES.size(); ++b) {
+            std::vector<double> times(runs);
+            for (int i = 0; i < runs; ++i) {
+                size_t _ok = 0;
+                timer t;
+                for (size_t beg = 0; beg < batch_queries.size(); beg += BATCH_SIZES[b]) {
+                    size_t num = std::min(BATCH_SIZES[b], batch_queries.size() - beg);
+                    _ok += search_batch(*wrapper, batch_queries.data() + beg, num, results.get());
+                }
+                times[i] = t.get<std::micro>() / batch_queries.size();
+                if (_ok != ok) {
+                    std::cerr << "critical error for search results" << std::endl;
+                    return 1;
+                }
+            }
+            batch_us_per_query[b] = get_average(times);
+            best_batch_us_per_query[b] = get_min(times);
+        }
+    }
+
+    // Saving the dictionary of the last run and loading it into a new one, as on restart. The page cache of the file
+    // is dropped before loading so that the load reads from the device.
+    size_t saved_bytes = 0;
+    double save_us = 0.0, load_us = 0.0, post_load_search_us_per_query = 0.0;
+    uint64_t first_query_ns = 0;
+    if constexpr (has_save_load<Wrapper>::value) {
+        if (!opts.save_fn.empty()) {
+            {
+                timer t;
+                if (!wrapper->save(opts.save_fn)) {
+                    std::cerr << "save error: save_fn = " << opts.save_fn << std::endl;
+                    return 1;
+                }
+                save_us = t.get<std::micro>();
+            }
+            saved_bytes = drop_file_cache(opts.save_fn);
+
+            auto loaded = std::make_unique<Wrapper>(args);
+            {
+                timer t;
+                if (!loaded->load(opts.save_fn)) {
+                    std::cerr << "load error: save_fn = " << opts.save_fn << std::endl;
+                    return 1;
+                }
+                load_us = t.get<std::micro>();
+            }
+            {
+                const uint64_t beg = now_ns();
+                loaded->search(lookup_queries[0]);
+                first_query_ns = now_ns() - beg;
+            }
+            size_t _ok = 0;
+            {
+                timer t;
+                for (const auto& query : lookup_queries) {
+                    _ok += loaded->search(query);
+                }
+                post_load_search_us_per_query = t.get<std::micro>() / queries->size();
+            }
+            if (_ok != ok) {
+                std::cerr << "critical error for search results after loading" << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    // Erasure of a part of the keys from the dictionary of the last run
+    size_t num_erased = 0;
+    double erase_us_per_key = 0.0, post_erase_hit_us_per_query = 0.0, post_erase_miss_us_per_query = 0.0;
+    alloc_tracker::phase erase_heap;
+    int64_t erase_process_size = 0;  // can be negative
+    if constexpr (has_erase<Wrapper>::value) {
+        if (opts.erase_ratio > 0.0) {
+            std::vector<std::string_view> erase_keys(keys->begin(), keys->end());
+            std::sort(erase_keys.begin(), erase_keys.end());
+            erase_keys.erase(std::unique(erase_keys.begin(), erase_keys.end()), erase_keys.end());
+            reorder_keys(erase_keys, "shuffle", opts.seed);
+            const auto erase_lookups = make_lookup_keys<Wrapper>(erase_keys.begin(), erase_keys.end());
+
+            num_erased = static_cast<size_t>(erase_keys.size() * opts.erase_ratio);
+            const size_t num_remaining = erase_keys.size() - num_erased;
+
+            erase_process_size = -static_cast<int64_t>(get_process_size());
+            erase_heap.start();
+            {
+                timer t;
+                for (size_t i = 0; i < num_erased; ++i) {
+                    wrapper->erase(erase_lookups[i]);
+                }
+                erase_us_per_key = t.get<std::micro>() / std::max<size_t>(1, num_erased);
+            }
+            erase_heap.stop();
+            erase_process_size += get_process_size();
+
+            size_t hit_ok = 0, miss_ok = 0;
+            {
+                timer t;
+                for (size_t i = num_erased; i < erase_keys.size(); ++i) {
+                    hit_ok += wrapper->search(erase_lookups[i]);
+                }
+                post_erase_hit_us_per_query = t.get<std::micro>() / std::max<size_t>(1, num_remaining);
+            }
+            {
+                timer t;
+                for (size_t i = 0; i < num_erased; ++i) {
+                    miss_ok += wrapper->search(erase_lookups[i]);
+                }
+                post_erase_miss_us_per_query = t.get<std::micro>() / std::max<size_t>(1, num_erased);
+            }
+            if ((hit_ok != num_remaining) or (miss_ok != 0)) {
+                std::cerr << "critical error for search results after erasure" << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    // An extra run timing every operation; kept apart from the runs above so that they are not slowed down.
+    uint64_t timer_overhead_ns = 0;
+    latency_histogram insert_hist, search_hist;
+    if (opts.latency) {
+        timer_overhead_ns = measure_timer_overhead();
+        auto elapsed_ns = [&](uint64_t beg, uint64_t end) {
+            return end - beg > timer_overhead_ns ? end - beg - timer_overhead_ns : 0;
+        };
+
+        wrapper = std::make_unique<Wrapper>(args);
+        for (std::string_view key : insert_keys) {
+            uint64_t beg = now_ns();
+            wrapper->insert(key);
+            insert_hist.record(elapsed_ns(beg, now_ns()));
+        }
+        for (const auto& query : lookup_queries) {
+            uint64_t beg = now_ns();
+            wrapper->search(query);
+            search_hist.record(elapsed_ns(beg, now_ns()));
+        }
+    }
+
+    // An extra insertion run recording every change of the capacity, with the time since the start of the run,
+    // the index of the key, and the time of the insertion causing it.
+    struct growth_event {
+        uint64_t timestamp_ns;
+        size_t key_index;
+        uint64_t duration_ns;
+        size_t capacity;
+    };
+    std::vector<growth_event> growth_events;
+    uint64_t growth_run_ns = 0;
+    if constexpr (has_capacity<Wrapper>::value) {
+        if (!opts.growth_trace.empty()) {
+            std::ofstream ofs(opts.growth_trace);
+            if (!ofs) {
+                std::cerr << "open error: growth_trace = " << opts.growth_trace << std::endl;
+                return 1;
+            }
+
+            auto traced = std::make_unique<Wrapper>(args);
+            size_t capacity = traced->capacity();
+            const uint64_t run_beg = now_ns();
+            for (size_t i = 0; i < insert_keys.size(); ++i) {
+                const uint64_t beg = now_ns();
+                traced->insert(insert_keys[i]);
+                const uint64_t end = now_ns();
+                if (traced->capacity() != capacity) {
+                    capacity = traced->capacity();
+                    growth_events.push_back({beg - run_beg, i, end - beg, capacity});
+                }
+            }
+            growth_run_ns = now_ns() - run_beg;
+
+            ofs << "timestamp_ns,key_index,duration_ns,capacity\n";
+            for (const growth_event& e : growth_events) {
+                ofs << e.timestamp_ns << ',' << e.key_index << ',' << e.duration_ns << ',' << e.capacity << '\n';
+            }
+        }
+    }
+
+    std::cout << "mode:measure\n"
+              << "name:" << Wrapper::name() << '\n'
+              << "key_fn:" << key_fn << '\n'
+              << "query_fn:" << query_fn << '\n'
+              << "order:" << opts.order << '\n'
+              << "cluster_bytes:" << opts.cluster_bytes << '\n'
+              << "insert_runs:" << runs << '\n'
+              << "num_keys:" << num_keys << '\n'
+              << "insert_us_per_key:" << insert_us_per_key << '\n'
+              << "best_insert_us_per_key:" << best_insert_us_per_key << '\n'
+              << "search_runs:" << runs << '\n'
+              << "num_queries:" << num_queries << '\n'
+              << "search_us_per_query:" << search_us_per_query << '\n'
+              << "best_search_us_per_query:" << best_search_us_per_query << '\n'
+              << "ok:" << ok << '\n'
+              << "ng:" << ng << '\n'
+              << "process_size:" << process_size << '\n';
+    if (alloc_tracker::enabled()) {
+        show_heap(std::cout, "load", load_heap);
+        show_heap(std::cout, "insert", insert_heap);
+        show_heap(std::cout, "search", search_heap);
+        std::cout << "heap_bytes_per_key:" << double(insert_heap.live_bytes()) / num_keys << '\n';
+    }
+    if (opts.batch) {
+        std::cout << "search_batch:" << (has_search_batch<Wrapper>::value ? "native" : "generic") << '\n';
+        for (size_t b = 0; b < BATCH_SIZES.size(); ++b) {
+            std::cout << "batch_" << BATCH_SIZES[b] << "_us_per_query:" << batch_us_per_query[b] << '\n'
+                      << "best_batch_" << BATCH_SIZES[b] << "_us_per_query:" << best_batch_us_per_query[b] << '\n';
+        }
+    }
+    if (opts.cache_state == "cold") {
+        std::cout << "cache_state:" << opts.cache_state << '\n'
+                  << "evict_bytes:" << evict_bytes << '\n'
+                  << "cold_block_size:" << COLD_BLOCK << '\n'
+                  << "cold_block_queries:" << num_cold_block_queries << '\n'
+                  << "cold_search_us_per_query:" << cold_search_us_per_query << '\n'
+                  << "best_cold_search_us_per_query:" << best_cold_search_us_per_query << '\n'
+                  << "cold_queries:" << cold_query_hist.size() << '\n';
+        show_latency(std::cout, "cold_query", cold_query_hist);
+        show_latency(std::cout, "warm_query", warm_query_hist);
+    }
+    if (opts.expected_keys > 0) {
+        if constexpr (has_reserve<Wrapper>::value) {
+            std::cout << "expected_keys:" << opts.expected_keys << '\n'
+                      << "presized_insert_us_per_key:" << presized_insert_us_per_key << '\n'
+                      << "best_presized_insert_us_per_key:" << best_presized_insert_us_per_key << '\n'
+                      << "presized_search_us_per_query:" << presized_search_us_per_query << '\n';
+            if (alloc_tracker::enabled()) {
+                show_heap(std::cout, "presized", presized_heap);
+            }
+        } else {
+            std::cout << "reserve:unsupported\n";
+        }
+    }
+    if (!opts.save_fn.empty()) {
+        if constexpr (has_save_load<Wrapper>::value) {
+            std::cout << "saved_bytes:" << saved_bytes << '\n'
+                      << "save_us:" << save_us << '\n'
+                      << "save_mb_per_sec:" << saved_bytes / save_us << '\n'
+                      << "dict_load_us:" << load_us << '\n'
+                      << "dict_load_mb_per_sec:" << saved_bytes / load_us << '\n'
+                      << "first_query_after_load_ns:" << first_query_ns << '\n'
+                      << "post_load_search_us_per_query:" << post_load_search_us_per_query << '\n';
+        } else {
+            std::cout << "save:unsupported\n";
+        }
+    }
+    if (opts.erase_ratio > 0.0) {
+        if constexpr (has_erase<Wrapper>::value) {
+            std::cout << "erase_ratio:" << opts.erase_ratio << '\n'
+                      << "num_erased:" << num_erased << '\n'
+                      << "erase_us_per_key:" << erase_us_per_key << '\n'
+                      << "post_erase_hit_us_per_query:" << post_erase_hit_us_per_query << '\n'
+                      << "post_erase_miss_us_per_query:" << post_erase_miss_us_per_query << '\n'
+                      << "erase_process_size:" << erase_process_size << '\n';
+            if (alloc_tracker::enabled()) {
+                show_heap(std::cout, "erase", erase_heap);
+                std::cout << "post_erase_heap_bytes:" << insert_heap.live_bytes() + erase_heap.live_bytes() << '\n';
+            }
+        } else {
+            std::cout << "erase:unsupported\n";
+        }
+    }
+    if (!opts.growth_trace.empty()) {
+        if constexpr (has_capacity<Wrapper>::value) {
+            uint64_t total_ns = 0, max_ns = 0;
+            for (const growth_event& e : growth_events) {
+                total_ns += e.duration_ns;
+                max_ns = std::max(max_ns, e.duration_ns);
+            }
+            std::cout << "growth_trace:" << opts.growth_trace << '\n'
+                      << "growth_events:" << growth_events.size() << '\n'
+                      << "growth_ns_total:" << total_ns << '\n'
+                      << "growth_ns_max:" << max_ns << '\n'
+                      << "growth_time_ratio:" << double(total_ns) / std::max<uint64_t>(1, growth_run_ns) << '\n';
+        } else {
+            std::cout << "growth_trace:unsupported\n";
+        }
+    }
+    if (opts.perf) {
+        show_perf(std::cout, "insert", "key", *insert_perf, num_keys * runs);
+        show_perf(std::cout, "search", "query", *search_perf, num_queries * runs);
+    }
+    if (opts.latency) {
+        std::cout << "timer_overhead_ns:" << timer_overhead_ns << '\n';
+        show_latency(std::cout, "insert", insert_hist);
+        show_latency(std::cout, "search", search_hist);
+    }
+    std::cout << "-- extra stats --\n";
+    wrapper->show_stat(std::cout);
+
+    return 0;
+}
+
+// Builds the dictionary once and measures the read throughput of 1..max_threads concurrent searchers.
+// Each searcher is pinned to its own logical CPU and scans either the whole query set (shared) or its own
+// contiguous slice of it (disjoint) for the given # of runs.
+template <class Wrapper>
+int bench_threads(const bench_options& opts) {
+    const int runs = opts.runs;
+    const std::string& key_fn = opts.key_fn;
+    const std::string& query_fn = opts.query_fn;
+    const std::vector<std::string>& args = opts.args;
+    const int max_threads = opts.threads;
+    const bool disjoint = opts.disjoint;
+
+    auto keys = std::make_shared<key_arena>();
+    if (!keys->load(key_fn)) {
+        std::cerr << "open error: key_fn = " << key_fn << std::endl;
+        return 1;
+    }
+    auto queries = keys;
+    if (query_fn != "-") {
+        queries = std::make_shared<key_arena>();
+        if (!queries->load(query_fn)) {
+            std::cerr << "open error: query_fn = " << query_fn << std::endl;
+            return 1;
+        }
+    }
+
+    auto wrapper = std::make_unique<Wrapper>(args);
+    for (std::string_view key : *keys) {
+        wrapper->insert(key);
+    }
+
+    const auto lookup_queries = make_lookup_keys<Wrapper>(queries->begin(), queries->end());
+    size_t ok = 0;
+    for (const auto& query : lookup_queries) {
+        ok += wrapper->search(query);
+    }
+
+    const unsigned num_cpus = std::max(1U, std::thread::hardware_concurrency());
+    const unsigned first_cpu = std::max(0, opts.pin_cpu);
+
+    std::cout << "mode:threads\n"
+              << "name:" << Wrapper::name() << '\n'
+              << "key_fn:" << key_fn << '\n'
+              << "query_fn:" << query_fn << '\n'
+              << "num_keys:" << keys->size() << '\n'
+              << "num_queries:" << queries->size() << '\n'
+              << "search_runs:" << runs << '\n'
+              << "slicing:" << (disjoint ? "disjoint" : "shared") << '\n'
+              << "num_cpus:" << num_cpus << '\n'
+              << "searcher_cpus:" << cpu_list(first_cpu, max_threads, num_cpus) << '\n'
+              << "ok:" << ok << '\n'
+              << "ng:" << queries->size() - ok << '\n';
+
+    for (int num_threads = 1; num_threads <= max_threads; ++num_threads) {
+        std::vector<size_t> num_ops(num_threads), num_ok(num_threads);
+        std::vector<double> elapsed_sec(num_threads);
+        std::atomic<int> num_ready{0};
+        std::atomic<bool> go{false};
+
+        auto searcher = [&](int tid) {
+            pin_thread((first_cpu + tid) % num_cpus);
+
+            size_t beg = 0, end = queries->size();
+            if (disjoint) {
+                beg = queries->size() * tid / num_threads;
+                end = queries->size() * (tid + 1) / num_threads;
+            }
+
+            ++num_ready;
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+
+            size_t _ok = 0;
+            timer t;
+            for (int r = 0; r < runs; ++r) {
+                for (size_t i = beg; i < end; ++i) {
+                    _ok += wrapper->search(lookup_queries[i]);
+                }
+            }
+            elapsed_sec[tid] = t.get<>();
+            num_ops[tid] = (end - beg) * runs;
+            num_ok[tid] = _ok;
+        };
+
+        std::vector<std::thread> threads;
+        for (int tid = 0; tid < num_threads; ++tid) {
+            threads.emplace_back(searcher, tid);
+        }
+        while (num_ready.load() != num_threads) {
+            std::this_thread::yield();
+        }
+
+        timer t;
+        go.store(true, std::memory_order_release);
+        for (auto& th : threads) {
+            th.join();
+        }
+        const double wall_sec = t.get<>();
+
+        size_t total_ops = std::accumulate(num_ops.begin(), num_ops.end(), size_t(0));
+        size_t total_ok = std::accumulate(num_ok.begin(), num_ok.end(), size_t(0));
+        size_t expected_ok = disjoint ? ok * runs : ok * runs * num_threads;
+        if (total_ok != expected_ok) {
+            std::cerr << "critical error for search results" << std::endl;
+            return 1;
+        }
+
+        std::cout << "threads_" << num_threads << "_mops:" << total_ops / wall_sec / 1000000.0 << '\n'
+                  << "threads_" << num_threads << "_per_thread_mops:";
+        for (int tid = 0; tid < num_threads; ++tid) {
+            std::cout << (tid != 0 ? "," : "") << num_ops[tid] / elapsed_sec[tid] / 1000000.0;
+        }
+        std::cout << '\n';
+    }
+
+    std::cout << "-- extra stats --\n";
+    wrapper->show_stat(std::cout);
+
+    return 0;
+}
+
+// Order-independent checksum of a key, summed over a stream to verify it without retaining the keys.
+inline uint64_t key_checksum(std::string_view key) {
+    return keygen::mix(0, std::hash<std::string_view>()(key));
+}
+
+// Builds the dictionary from a key stream and searches a query stream, so that neither the keys nor the
+// queries are held in memory next to the dictionary and the sizes of production can be tested. The queries are
+// those of query_fn, num_ops keys regenerated at random if the keys are generated, or the keys streamed again.
+// The results are verified by the # of found keys and checksums over the streams. Each stream is also read
+// once without the dictionary, and the *_net_* times exclude the cost of reading or generating the keys.
+template <class Wrapper>
+int bench_stream(const bench_options& opts) {
+    const int runs = opts.runs;
+    const std::vector<std::string>& args = opts.args;
+
+    key_stream keys;
+    if (!keys.open(opts.key_fn, opts.seed)) {
+        std::cerr << "open error: key_fn = " << opts.key_fn << std::endl;
+        return 1;
+    }
+    const bool has_queries = opts.query_fn != "-";
+    key_stream queries;
+    if (has_queries and !queries.open(opts.query_fn, opts.seed + 1)) {
+        std::cerr << "open error: query_fn = " << opts.query_fn << std::endl;
+        return 1;
+    }
+
+    uint64_t num_keys = 0, keys_checksum = 0;
+    double source_us = 0.0;
+    {
+        timer t;
+        for (std::string_view key; keys.next(key);) {
+            keys_checksum += key_checksum(key);
+            ++num_keys;
+        }
+        source_us = t.get<std::micro>();
+    }
+    if (num_keys == 0) {
+        std::cerr << "error: no keys" << std::endl;
+        return 1;
+    }
+
+    const bool random_queries = !has_queries and keys.generated();
+    auto for_each_query = [&](auto&& fn) {
+        if (has_queries) {
+            queries.rewind();
+            for (std::string_view query; queries.next(query);) {
+                fn(query);
+            }
+        } else if (random_queries) {
+            keygen::random rnd(opts.seed + 1);
+            const uint64_t num_ops = opts.num_ops != 0 ? opts.num_ops : num_keys;
+            for (uint64_t i = 0; i < num_ops; ++i) {
+                fn(keys.get(rnd.next_below(num_keys)));
+            }
+        } else {
+            keys.rewind();
+            for (std::string_view query; keys.next(query);) {
+                fn(query);
+            }
+        }
+    };
+
+    uint64_t num_queries = 0, queries_checksum = 0;
+    double query_source_us = 0.0;
+    {
+        timer t;
+        for_each_query([&](std::string_view query) {
+            queries_checksum += key_checksum(query);
+            ++num_queries;
+        });
+        query_source_us = t.get<std::micro>();
+    }
+
+    // heap and RSS are relative to those before the build
+    const int64_t live_beg = alloc_tracker::live_bytes();
+    const int64_t process_beg = static_cast<int64_t>(get_process_size());
+    auto wrapper = std::make_unique<Wrapper>(args);
+
+    double insert_us = 0.0;
+    {
+        uint64_t checksum = 0;
+        keys.rewind();
+        timer t;
+        for (std::string_view key; keys.next(key);) {
+            wrapper->insert(key);
+            checksum += key_checksum(key);
+        }
+        insert_us = t.get<std::micro>();
+        if (checksum != keys_checksum) {
+            std::cerr << "critical error for the key stream" << std::endl;
+            return 1;
+        }
+    }
+    const int64_t heap_live_bytes = alloc_tracker::live_bytes() - live_beg;
+    const int64_t process_size = static_cast<int64_t>(get_process_size()) - process_beg;
+
+    std::vector<double> times(runs);
+    size_t ok = 0;
+    for (int i = 0; i < runs; ++i) {
+        size_t _ok = 0;
+        uint64_t checksum = 0;
+        timer t;
+        for_each_query([&](std::string_view query) {
+            _ok += wrapper->search(query);
+            checksum += key_checksum(query);
+        });
+        times[i] = t.get<std::micro>();
+        if (checksum != queries_checksum or (i != 0 and _ok != ok) or (!has_queries and _ok != num_queries)) {
+            std::cerr << "critical error for search results" << std::endl;
+            return 1;
+        }
+        ok = _ok;
+    }
+
+    const double search_us = get_average(times);
+    std::cout << "mode:stream\n"
+              << "name:" << Wrapper::name() << '\n'
+              << "key_fn:" << opts.key_fn << '\n'
+              << "query_fn:" << opts.query_fn << '\n'
+              << "key_source:" << (keys.generated() ? "generator" : "file") << '\n'
+              << "num_keys:" << num_keys << '\n'
+              << "keys_checksum:" << keys_checksum << '\n'
+              << "source_us_per_key:" << source_us / num_keys << '\n'
+              << "insert_us_per_key:" << insert_us / num_keys << '\n'
+              << "insert_net_us_per_key:" << (insert_us - source_us) / num_keys << '\n'
+              << "process_size:" << process_size << '\n'
+              << "process_bytes_per_key:" << double(process_size) / num_keys << '\n';
+    if (alloc_tracker::enabled()) {
+        std::cout << "heap_live_bytes:" << heap_live_bytes << '\n'
+                  << "heap_bytes_per_key:" << double(heap_live_bytes) / num_keys << '\n';
+    }
+    std::cout << "search_runs:" << runs << '\n'
+              << "num_queries:" << num_queries << '\n'
+              << "queries_checksum:" << queries_checksum << '\n'
+              << "query_source_us_per_query:" << query_source_us / std::max<uint64_t>(1, num_queries) << '\n'
+              << "search_us_per_query:" << search_us / std::max<uint64_t>(1, num_queries) << '\n'
+              << "best_search_us_per_query:" << get_min(times) / std::max<uint64_t>(1, num_queries) << '\n'
+              << "search_net_us_per_query:" << (search_us - query_source_us) / std::max<uint64_t>(1, num_queries)
+              << '\n'
+              << "ok:" << ok << '\n'
+              << "ng:" << num_queries - ok << '\n'
+              << "-- extra stats --\n";
+    wrapper->show_stat(std::cout);
+
+    return 0;
+}
+
+// Measures the latency of searches arriving at offered loads regardless of the progress of the searchers
+// (open loop). A scheduler thread releases num_ops queries at their intended send times, which are evenly
+// spaced (constant) or exponentially distributed (poisson), into a FIFO served by the worker threads. The
+// latency of a query is taken from its intended send time to the completion of its search, so that a stall of
+// the scheduler or queueing behind slow searches is charged to the queries that would have waited for it
+// (no coordinated omission). Loads are given in queries/sec or, with a suffix '%', relative to the saturation
+// throughput of the workers measured in closed loop first.
+template <class Wrapper>
+int bench_open_loop(const bench_options& opts) {
+    const std::vector<std::string>& args = opts.args;
+    const int num_workers = opts.workers;
+    const unsigned num_cpus = std::max(1U, std::thread::hardware_concurrency());
+    const unsigned first_cpu = std::max(0, opts.pin_cpu);
+    // busy waits yield only if the scheduler and the workers outnumber the CPUs
+    const bool oversubscribed = unsigned(num_workers) + 1 > num_cpus;
+
+    key_arena keys;
+    if (!keys.load(opts.key_fn)) {
+        std::cerr << "open error: key_fn = " << opts.key_fn << std::endl;
+        return 1;
+    }
+    key_arena queries;
+    if (opts.query_fn != "-" and !queries.load(opts.query_fn)) {
+        std::cerr << "open error: query_fn = " << opts.query_fn << std::endl;
+        return 1;
+    }
+    const key_arena& query_set = opts.query_fn != "-" ? queries : keys;
+    if (query_set.size() == 0) {
+        std::cerr << "error: no queries" << std::endl;
+        return 1;
+    }
+
+    auto wrapper = std::make_unique<Wrapper>(args);
+    for (std::string_view key : keys) {
+        wrapper->insert(key);
+    }
+
+    // the queries in the order of arrival
+    const size_t num_ops = opts.num_ops != 0 ? opts.num_ops : query_set.size();
+    std::vector<lookup_key_t<Wrapper>> requests(num_ops);
+    size_t expected_ok = 0;
+    {
+        keygen::random rnd(opts.seed);
+        for (auto& query : requests) {
+            query = query_set[rnd.next_below(query_set.size())];
+            expected_ok += wrapper->search(query);
+        }
+    }
+
+    // Closed loop: the workers take the next query as soon as they finish one.
+    double saturation_qps = 0.0;
+    {
+        std::atomic<size_t> next{0}, num_ok{0};
+        std::atomic<int> num_ready{0};
+        std::atomic<bool> go{false};
+        auto worker = [&](int tid) {
+            pin_thread((first_cpu + tid + 1) % num_cpus);
+            ++num_ready;
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            size_t _ok = 0;
+            for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < num_ops;) {
+                _ok += wrapper->search(requests[i]);
+            }
+            num_ok += _ok;
+        };
+        std::vector<std::thread> threads;
+        for (int tid = 0; tid < num_workers; ++tid) {
+            threads.emplace_back(worker, tid);
+        }
+        while (num_ready.load() != num_workers) {
+            std::this_thread::yield();
+        }
+        timer t;
+        go.store(true, std::memory_order_release);
+        for (auto& th : threads) {
+            th.join();
+        }
+        saturation_qps = num_ops / t.get<>();
+        if (num_ok.load() != expected_ok) {
+            std::cerr << "critical error for search results" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<double> offered_qps;
+    for (const std::string& load : opts.loads) {
+        char* end = nullptr;
+        const double value = std::strtod(load.c_str(), &end);
+        const bool relative = end != load.c_str() and std::string(end) == "%";
+        if (end == load.c_str() or (*end != '\0' and !relative) or !(value > 0.0)) {
+            std::cerr << "error: invalid load = " << load << std::endl;
+            return 1;
+        }
+        offered_qps.push_back(relative ? saturation_qps * value / 100.0 : value);
+    }
+
+    std::cout << "mode:open_loop\n"
+              << "name:" << Wrapper::name() << '\n'
+              << "key_fn:" << opts.key_fn << '\n'
+              << "query_fn:" << opts.query_fn << '\n'
+              << "num_keys:" << keys.size() << '\n'
+              << "num_ops:" << num_ops << '\n'
+              << "arrival:" << opts.arrival << '\n'
+              << "workers:" << num_workers << '\n'
+              << "num_cpus:" << num_cpus << '\n'
+              << "scheduler_cpu:" << first_cpu % num_cpus << '\n'
+              << "worker_cpus:" << cpu_list(first_cpu + 1, num_workers, num_cpus) << '\n'
+              << "saturation_qps:" << saturation_qps << '\n'
+              << "num_loads:" << offered_qps.size() << '\n';
+
+    std::vector<uint64_t> send_ns(num_ops);  // intended send times relative to the start
+    for (size_t l = 0; l < offered_qps.size(); ++l) {
+        const double interval_ns = 1e9 / offered_qps[l];
+        {
+            keygen::random rnd(opts.seed + 1 + l);
+            double t = 0.0;
+            for (uint64_t& ns : send_ns) {
+                ns = static_cast<uint64_t>(t);
+                t += opts.arrival == "poisson" ? -std::log(1.0 - rnd.next_double()) * interval_ns : interval_ns;
+            }
+        }
+
+        std::atomic<size_t> released{0}, next{0}, num_ok{0};
+        std::atomic<uint64_t> start_ns{0}, last_done_ns{0};
+        std::atomic<int> num_ready{0};
+        std::atomic<bool> go{false};
+        // one per worker, on cache lines of its own so that the records of neighbors do not share them
+        struct alignas(64) worker_histogram {
+            latency_histogram hist;
+        };
+        std::vector<worker_histogram> hists(num_workers);
+        uint64_t max_send_lag_ns = 0;
+
+        auto scheduler = [&]() {
+            pin_thread(first_cpu % num_cpus);
+            ++num_ready;
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            const uint64_t beg = now_ns();
+            start_ns.store(beg, std::memory_order_release);
+            for (size_t i = 0; i < num_ops; ++i) {
+                const uint64_t target = beg + send_ns[i];
+                uint64_t now = now_ns();
+                while (now < target) {
+                    if (oversubscribed) {
+                        std::this_thread::yield();
+                    }
+                    now = now_ns();
+                }
+                max_send_lag_ns = std::max(max_send_lag_ns, now - target);
+                released.store(i + 1, std::memory_order_release);
+            }
+        };
+        auto worker = [&](int tid) {
+            pin_thread((first_cpu + tid + 1) % num_cpus);
+            ++num_ready;
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            size_t _ok = 0;
+            uint64_t done = 0;
+            for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < num_ops;) {
+                // spins so that a released query is taken without the wake-up delay of blocking
+                while (released.load(std::memory_order_acquire) <= i) {
+                    if (oversubscribed) {
+                        std::this_thread::yield();
+                    }
+                }
+                _ok += wrapper->search(requests[i]);
+                done = now_ns();
+                hists[tid].hist.record(done - (start_ns.load(std::memory_order_acquire) + send_ns[i]));
+            }
+            num_ok += _ok;
+            uint64_t last = last_done_ns.load();
+            while (last < done and !last_done_ns.compare_exchange_weak(last, done)) {
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.emplace_back(scheduler);
+        for (int tid = 0; tid < num_workers; ++tid) {
+            threads.emplace_back(worker, tid);
+        }
+        while (num_ready.load() != num_workers + 1) {
+            std::this_thread::yield();
+        }
+        go.store(true, std::memory_order_release);
+        for (auto& th : threads) {
+            th.join();
+        }
+        if (num_ok.load() != expected_ok) {
+            std::cerr << "critical error for search results" << std::endl;
+            return 1;
+        }
+
+        latency_histogram hist;
+        for (const worker_histogram& h : hists) {
+            hist.merge(h.hist);
+        }
+        const std::string pfx = "load_" + std::to_string(l);
+        std::cout << pfx << "_offered_qps:" << offered_qps[l] << '\n'
+                  << pfx << "_offered_ratio:" << offered_qps[l] / saturation_qps << '\n'
+                  << pfx << "_achieved_qps:" << num_ops / ((last_done_ns.load() - start_ns.load()) / 1e9) << '\n'
+                  << pfx << "_max_send_lag_ns:" << max_send_lag_ns << '\n';
+        show_latency(std::cout, pfx + "_latency", hist);
+    }
+
+    std::cout << "-- extra stats --\n";
+    wrapper->show_stat(std::cout);
+
+    return 0;
+}
+
+// Measures searches for a mix of present keys and generated absent queries, as well as each of them separately.
+template <class Wrapper>
+int bench_negative(const bench_options& opts) {
+    const int runs = opts.runs;
+    const std::vector<std::string>& args = opts.args;
+
+    key_arena keys;
+    if (!keys.load(opts.key_fn)) {
+        std::cerr << "open error: key_fn = " << opts.key_fn << std::endl;
+        return 1;
+    }
+
+    const size_t num_queries = keys.size();
+    const size_t num_misses = static_cast<size_t>(num_queries * opts.miss_ratio);
+    const size_t num_hits = num_queries - num_misses;
+
+    key_arena hits, misses, mixed;
+    {
+        keygen::random rnd(opts.seed);
+        std::vector<std::string> strs;
+        for (size_t i = 0; i < num_hits; ++i) {
+            strs.emplace_back(keys[rnd.next_below(keys.size())]);
+        }
+        hits.assign(strs);
+
+        std::vector<std::string> absents;
+        if (!make_absent_queries(keys, opts.negative, num_misses, opts.seed + 1, absents)) {
+            std::cerr << "error: absent queries cannot be generated" << std::endl;
+            return 1;
+        }
+        misses.assign(absents);
+
+        strs.insert(strs.end(), absents.begin(), absents.end());
+        for (size_t i = strs.size(); i > 1; --i) {
+            std::swap(strs[i - 1], strs[rnd.next_below(i)]);
+        }
+        mixed.assign(strs);
+    }
+
+    const auto mixed_lookups = make_lookup_keys<Wrapper>(mixed.begin(), mixed.end());
+    const auto hit_lookups = make_lookup_keys<Wrapper>(hits.begin(), hits.end());
+    const auto miss_lookups = make_lookup_keys<Wrapper>(misses.begin(), misses.end());
+
+    std::unique_ptr<Wrapper> wrapper;
+    std::vector<double> mixed_times(runs), hit_times(runs), miss_times(runs);
+    size_t mixed_ok = 0, hit_ok = 0, miss_ok = 0;
+
+    for (int i = 0; i < runs; ++i) {
+        wrapper.reset();
+        wrapper = std::make_unique<Wrapper>(args);
+        for (std::string_view key : keys) {
+            wrapper->insert(key);
+        }
+
+        auto measure = [&](const std::vector<lookup_key_t<Wrapper>>& queries, size_t& ok) {
+            size_t _ok = 0;
+            timer t;
+            for (const auto& query : queries) {
+                _ok += wrapper->search(query);
+            }
+            ok = _ok;
+            return t.get<std::micro>() / std::max<size_t>(1, queries.size());
+        };
+        mixed_times[i] = measure(mixed_lookups, mixed_ok);
+        hit_times[i] = measure(hit_lookups, hit_ok);
+        miss_times[i] = measure(miss_lookups, miss_ok);
+
+        if ((mixed_ok != num_hits) or (hit_ok != num_hits) or (miss_ok != 0)) {
+            std::cerr << "critical error for search results" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "mode:negative\n"
+              << "name:" << Wrapper::name() << '\n'
+              << "key_fn:" << opts.key_fn << '\n'
+              << "negative:" << opts.negative << '\n'
+              << "miss_ratio:" << opts.miss_ratio << '\n'
+              << "seed:" << opts.seed << '\n'
+              << "num_keys:" << keys.size() << '\n'
+              << "search_runs:" << runs << '\n'
+              << "num_queries:" << num_queries << '\n'
+              << "num_hits:" << num_hits << '\n'
+              << "num_misses:" << num_misses << '\n'
+              << "search_us_per_query:" << get_average(mixed_times) << '\n'
+              << "best_search_us_per_query:" << get_min(mixed_times) << '\n'
+              << "hit_us_per_query:" << get_average(hit_times) << '\n'
+              << "best_hit_us_per_query:" << get_min(hit_times) << '\n'
+              << "miss_us_per_query:" << get_average(miss_times) << '\n'
+              << "best_miss_us_per_query:" << get_min(miss_times) << '\n';
+
+    if (opts.latency) {
+        const uint64_t timer_overhead_ns = measure_timer_overhead();
+        latency_histogram hit_hist, miss_hist;
+        for (const auto& query : mixed_lookups) {
+            uint64_t beg = now_ns();
+            bool found = wrapper->search(query);
+            uint64_t elapsed = now_ns() - beg;
+            (found ? hit_hist : miss_hist).record(elapsed > timer_overhead_ns ? elapsed - timer_overhead_ns : 0);
+        }
+        std::cout << "timer_overhead_ns:" << timer_overhead_ns << '\n';
+        show_latency(std::cout, "hit", hit_hist);
+        show_latency(std::cout, "miss", miss_hist);
+    }
+
+    std::cout << "-- extra stats --\n";
+    wrapper->show_stat(std::cout);
+
+    return 0;
+}
+
+// Holds the dictionary at half of the distinct keys and, in each round, replaces a part of it by erasing
+// resident keys and inserting evicted ones. Heap, RSS and search time sampled after every round show how
+// each structure fragments and reclaims memory under steady-state churn.
+template <class Wrapper>
+int bench_churn(const bench_options& opts) {
+    if constexpr (!has_erase<Wrapper>::value) {
+        std::cout << "mode:churn\n"
+                  << "name:" << Wrapper::name() << '\n'
+                  << "key_fn:" << opts.key_fn << '\n'
+                  << "churn:unsupported\n";
+        return 0;
+    } else {
+        const std::vector<std::string>& args = opts.args;
+
+        key_arena keys;
+        if (!keys.load(opts.key_fn)) {
+            std::cerr << "open error: key_fn = " << opts.key_fn << std::endl;
+            return 1;
+        }
+
+        std::vector<std::string_view> distinct(keys.begin(), keys.end());
+        std::sort(distinct.begin(), distinct.end());
+        distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+        if (distinct.size() < 2) {
+            std::cerr << "error: churn needs at least two distinct keys" << std::endl;
+            return 1;
+        }
+        reorder_keys(distinct, "shuffle", opts.seed);
+
+        auto resident = make_lookup_keys<Wrapper>(distinct.begin(), distinct.begin() + distinct.size() / 2);
+        // keys out of the dictionary, recycled in FIFO order
+        auto evicted = make_lookup_keys<Wrapper>(distinct.begin() + distinct.size() / 2, distinct.end());
+
+        const size_t num_resident = resident.size();
+        const size_t num_replaced = std::min(
+            evicted.size(), std::max<size_t>(1, static_cast<size_t>(num_resident * opts.churn_ratio)));
+
+        struct sample {
+            double churn_us_per_op;
+            double search_us_per_query;
+            uint64_t search_ns_p99;
+            int64_t heap_live_bytes;
+            int64_t process_size;
+        };
+        std::vector<sample> samples;
+        samples.reserve(opts.churn + 1);
+
+        const uint64_t timer_overhead_ns = opts.latency ? measure_timer_overhead() : 0;
+        latency_histogram hist;  // reused so that no round allocates for it
+
+        // Samples the state after a round; heap and RSS are relative to those before the build.
+        const int64_t live_beg = alloc_tracker::live_bytes();
+        const int64_t process_beg = static_cast<int64_t>(get_process_size());
+        std::unique_ptr<Wrapper> wrapper;
+        auto take_sample = [&](double churn_us_per_op) -> bool {
+            sample s;
+            s.churn_us_per_op = churn_us_per_op;
+            s.heap_live_bytes = alloc_tracker::live_bytes() - live_beg;
+            s.process_size = static_cast<int64_t>(get_process_size()) - process_beg;
+
+            size_t ok = 0;
+            s.search_ns_p99 = 0;
+            if (opts.latency) {
+                hist.clear();
+                for (const auto& key : resident) {
+                    uint64_t beg = now_ns();
+                    ok += wrapper->search(key);
+                    uint64_t elapsed = now_ns() - beg;
+                    hist.record(elapsed > timer_overhead_ns ? elapsed - timer_overhead_ns : 0);
+                }
+                s.search_us_per_query = hist.mean() / 1000.0;
+                s.search_ns_p99 = hist.percentile(0.99);
+            } else {
+                timer t;
+                for (const auto& key : resident) {
+                    ok += wrapper->search(key);
+                }
+                s.search_us_per_query = t.get<std::micro>() / num_resident;
+            }
+            samples.push_back(s);
+            return ok == num_resident;
+        };
+
+        double build_us_per_key = 0.0;
+        {
+            wrapper = std::make_unique<Wrapper>(args);
+            timer t;
+            for (const auto& key : resident) {
+                wrapper->insert(key);
+            }
+            build_us_per_key = t.get<std::micro>() / num_resident;
+        }
+        if (!take_sample(0.0)) {
+            std::cerr << "critical error for search results" << std::endl;
+            return 1;
+        }
+
+        keygen::random rnd(opts.seed + 1);
+        size_t next_evicted = 0;
+        for (int r = 1; r <= opts.churn; ++r) {
+            timer t;
+            for (size_t i = 0; i < num_replaced; ++i) {
+                auto& victim = resident[rnd.next_below(num_resident)];
+                wrapper->erase(victim);
+                std::swap(victim, evicted[next_evicted]);
+                wrapper->insert(victim);
+                next_evicted = (next_evicted + 1) % evicted.size();
+            }
+            if (!take_sample(t.get<std::micro>() / (2 * num_replaced))) {
+                std::cerr << "critical error for search results in round " << r << std::endl;
+                return 1;
+            }
+        }
+
+        std::cout << "mode:churn\n"
+                  << "name:" << Wrapper::name() << '\n'
+                  << "key_fn:" << opts.key_fn << '\n'
+                  << "seed:" << opts.seed << '\n'
+                  << "num_resident:" << num_resident << '\n'
+                  << "churn_rounds:" << opts.churn << '\n'
+                  << "churn_ratio:" << opts.churn_ratio << '\n'
+                  << "num_replaced_per_round:" << num_replaced << '\n'
+                  << "build_us_per_key:" << build_us_per_key << '\n';
+        // round 0 is the state just after the build
+        for (size_t r = 0; r < samples.size(); ++r) {
+            const std::string pfx = "round_" + std::to_string(r);
+            if (r > 0) {
+                std::cout << pfx << "_churn_us_per_op:" << samples[r].churn_us_per_op << '\n';
+            }
+            std::cout << pfx << "_search_us_per_query:" << samples[r].search_us_per_query << '\n'
+                      << pfx << "_process_size:" << samples[r].process_size << '\n';
+            if (alloc_tracker::enabled()) {
+                std::cout << pfx << "_heap_live_bytes:" << samples[r].heap_live_bytes << '\n';
+            }
+            if (opts.latency) {
+                std::cout << pfx << "_search_ns_p99:" << samples[r].search_ns_p99 << '\n';
+            }
+        }
+        const sample& first = samples.front();
+        const sample& last = samples.back();
+        std::cout << "search_slowdown:" << last.search_us_per_query / first.search_us_per_query << '\n'
+                  << "process_size_growth:" << last.process_size - first.process_size << '\n';
+        if (alloc_tracker::enabled()) {
+            std::cout << "heap_growth:" << last.heap_live_bytes - first.heap_live_bytes << '\n';
+        }
+        if (opts.latency) {
+            std::cout << "timer_overhead_ns:" << timer_overhead_ns << '\n';
+        }
+        std::cout << "-- extra stats --\n";
+        wrapper->show_stat(std::cout);
+
+        return 0;
+    }
+}
+
+// Enumerates the completions of query prefixes, i.e., the first prefix_len bytes of the queries, up to
+// prefix_limit per prefix. Wrappers without native prefix search are reported as unsupported.
+template <class Wrapper>
+int bench_prefix(const bench_options& opts) {
+    if constexpr (!has_prefix_search<Wrapper>::value) {
+        std::cout << "mode:prefix\n"
+                  << "name:" << Wrapper::name() << '\n'
+                  << "key_fn:" << opts.key_fn << '\n'
+                  << "prefix_search:unsupported\n";
+        return 0;
+    } else {
+        const int runs = opts.runs;
+        const std::vector<std::string>& args = opts.args;
+        const size_t limit = opts.prefix_limit == 0 ? SIZE_MAX : opts.prefix_limit;
+
+        key_arena keys;
+        if (!keys.load(opts.key_fn)) {
+            std::cerr << "open error: key_fn = " << opts.key_fn << std::endl;
+            return 1;
+        }
+        key_arena prefixes;
+        {
+            key_arena queries;
+            if (opts.query_fn != "-" and !queries.load(opts.query_fn)) {
+                std::cerr << "open error: query_fn = " << opts.query_fn << std::endl;
+                return 1;
+            }
+            std::vector<std::string> strs;
+            for (std::string_view query : opts.query_fn != "-" ? queries : keys) {
+                strs.emplace_back(query.substr(0, opts.prefix_len));
+            }
+            prefixes.assign(strs);
+        }
+
+        auto wrapper = std::make_unique<Wrapper>(args);
+        for (std::string_view key : keys) {
+            wrapper->insert(key);
+        }
+
+        std::vector<double> times(runs);
+        size_t num_results = 0;
+        for (int i = 0; i < runs; ++i) {
+            size_t _num_results = 0;
+            timer t;
+            for (std::string_view prefix : prefixes) {
+                _num_results += wrapper->prefix_search(prefix, limit);
+            }
+            times[i] = t.get<std::micro>();
+            if (i != 0 and _num_results != num_results) {
+                std::cerr << "critical error for prefix search results" << std::endl;
+                return 1;
+            }
+            num_results = _num_results;
+        }
+
+        const size_t num_prefixes = prefixes.size();
+        const double us = get_average(times), best_us = get_min(times);
+        std::cout << "mode:prefix\n"
+                  << "name:" << Wrapper::name() << '\n'
+                  << "key_fn:" << opts.key_fn << '\n'
+                  << "query_fn:" << opts.query_fn << '\n'
+                  << "prefix_len:" << opts.prefix_len << '\n'
+                  << "prefix_limit:" << opts.prefix_limit << '\n'
+                  << "num_keys:" << keys.size() << '\n'
+                  << "search_runs:" << runs << '\n'
+                  << "num_prefixes:" << num_prefixes << '\n'
+                  << "num_results:" << num_results << '\n'
+                  << "results_per_prefix:" << double(num_results) / std::max<size_t>(1, num_prefixes) << '\n'
+                  << "us_per_prefix:" << us / std::max<size_t>(1, num_prefixes) << '\n'
+                  << "best_us_per_prefix:" << best_us / std::max<size_t>(1, num_prefixes) << '\n'
+                  << "prefixes_per_sec:" << num_prefixes / us * 1e6 << '\n'
+                  << "results_per_sec:" << num_results / us * 1e6 << '\n'
+                  << "-- extra stats --\n";
+        wrapper->show_stat(std::cout);
+
+        return 0;
+    }
+}
+
+// # of bytes of the UTF-8 character starting with the given byte (1 for broken ones)
+inline size_t utf8_char_length(char c) {
+    const auto b = static_cast<unsigned char>(c);
+    if (b < 0xC0) {
+        return 1;
+    }
+    return b < 0xE0 ? 2 : (b < 0xF0 ? 3 : 4);
+}
+
+// Segments each line of a text with the dictionary of the keys. With match "all", the keys starting at every
+// UTF-8 character are found by common prefix search, as when building the lattice of a morphological analyzer;
+// with "longest", the line is greedily split into the longest matching keys, skipping a character where no key
+// matches.
+template <class Wrapper>
+int bench_tokenize(const bench_options& opts) {
+    const int runs = opts.runs;
+    const std::vector<std::string>& args = opts.args;
+    const bool longest = opts.match == "longest";
+
+    if ((longest and !has_longest_prefix<Wrapper>::value) or
+        (!longest and !has_common_prefix_search<Wrapper>::value)) {
+        std::cout << "mode:tokenize\n"
+                  << "name:" << Wrapper::name() << '\n'
+                  << "key_fn:" << opts.key_fn << '\n'
+                  << "match:" << opts.match << '\n'
+                  << "tokenize:unsupported\n";
+        return 0;
+    }
+
+    key_arena keys, text;
+    if (!keys.load(opts.key_fn)) {
+        std::cerr << "open error: key_fn = " << opts.key_fn << std::endl;
+        return 1;
+    }
+    if (!text.load(opts.text_fn)) {
+        std::cerr << "open error: text_fn = " << opts.text_fn << std::endl;
+        return 1;
+    }
+    size_t text_bytes = 0;
+    for (std::string_view line : text) {
+        text_bytes += line.size();
+    }
+
+    auto wrapper = std::make_unique<Wrapper>(args);
+    for (std::string_view key : keys) {
+        wrapper->insert(key);
+    }
+
+    // Returns the # of matches ("all") or tokens ("longest") in the line.
+    auto segment = [&](std::string_view line, size_t& num_unknowns) -> size_t {
+        size_t num = 0;
+        if (longest) {
+            if constexpr (has_longest_prefix<Wrapper>::value) {
+                for (size_t pos = 0; pos < line.size();) {
+                    size_t len = wrapper->longest_prefix(line.substr(pos));
+                    if (len == 0) {
+                        len = utf8_char_length(line[pos]);
+                        num_unknowns += 1;
+                    } else {
+                        num += 1;
+                    }
+                    pos += len;
+                }
+            }
+        } else {
+            if constexpr (has_common_prefix_search<Wrapper>::value) {
+                for (size_t pos = 0; pos < line.size(); pos += utf8_char_length(line[pos])) {
+                    num += wrapper->common_prefix_search(line.substr(pos));
+                }
+            }
+        }
+        return num;
+    };
+
+    std::vector<double> times(runs);
+    size_t num_found = 0, num_unknowns = 0;
+    for (int i = 0; i < runs; ++i) {
+        size_t _num_found = 0, _num_unknowns = 0;
+        timer t;
+        for (std::string_view line : text) {
+            _num_found += segment(line, _num_unknowns);
+        }
+        times[i] = t.get<std::micro>();
+        if (i != 0 and (_num_found != num_found or _num_unknowns != num_unknowns)) {
+            std::cerr << "critical error for tokenization results" << std::endl;
+            return 1;
+        }
+        num_found = _num_found;
+        num_unknowns = _num_unknowns;
+    }
+
+    std::cout << "mode:tokenize\n"
+              << "name:" << Wrapper::name() << '\n'
+              << "key_fn:" << opts.key_fn << '\n'
+              << "text_fn:" << opts.text_fn << '\n'
+              << "match:" << opts.match << '\n'
+              << "num_keys:" << keys.size() << '\n'
+              << "num_lines:" << text.size() << '\n'
+              << "text_bytes:" << text_bytes << '\n'
+              << "tokenize_runs:" << runs << '\n';
+    if (longest) {
+        std::cout << "num_tokens:" << num_found << '\n' << "num_unknowns:" << num_unknowns << '\n';
+    } else {
+        std::cout << "num_matches:" << num_found << '\n';
+    }
+    // bytes per microsecond, i.e., MB/s
+    std::cout << "mb_per_sec:" << text_bytes / get_average(times) << '\n'
+              << "best_mb_per_sec:" << text_bytes / get_min(times) << '\n'
+              << "-- extra stats --\n";
+    wrapper->show_stat(std::cout);
+
+    return 0;
+}
+
+// Measures the ordered enumeration of all the keys and lexicographic range scans [lo, hi) over scan_span
+// consecutive keys from random positions. The time to the first result is that of a scan limited to one key.
+template <class Wrapper>
+int bench_scan(const bench_options& opts) {
+    if constexpr (!has_range_scan<Wrapper>::value) {
+        std::cout << "mode:scan\n"
+                  << "name:" << Wrapper::name() << '\n'
+                  << "key_fn:" << opts.key_fn << '\n'
+                  << "scan:unsupported\n";
+        return 0;
+    } else {
+        const int runs = opts.runs;
+        const std::vector<std::string>& args = opts.args;
+
+        key_arena keys;
+        if (!keys.load(opts.key_fn)) {
+            std::cerr << "open error: key_fn = " << opts.key_fn << std::endl;
+            return 1;
+        }
+        std::vector<std::string_view> sorted(keys.begin(), keys.end());
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+        const size_t num_keys = sorted.size();
+
+        // the ranges and their expected # of keys; hi is unbounded at the end of the keys
+        struct range {
+            std::string_view lo, hi;
+            size_t num;
+        };
+        std::vector<range> ranges(opts.scan);
+        {
+            keygen::random rnd(opts.seed);
+            for (range& r : ranges) {
+                const size_t i = rnd.next_below(num_keys);
+                const size_t j = std::min(num_keys, i + opts.scan_span);
+                r = {sorted[i], j < num_keys ? sorted[j] : std::string_view(), j - i};
+            }
+        }
+
+        auto wrapper = std::make_unique<Wrapper>(args);
+        for (std::string_view key : keys) {
+            wrapper->insert(key);
+        }
+
+        std::vector<double> full_times(runs), full_first_times(runs), range_times(runs), range_first_times(runs);
+        for (int i = 0; i < runs; ++i) {
+            {
+                timer t;
+                const size_t num = wrapper->range_scan({}, {}, SIZE_MAX);
+                full_times[i] = t.get<std::micro>();
+                if (num != num_keys) {
+                    std::cerr << "critical error for full scan results" << std::endl;
+                    return 1;
+                }
+            }
+            {
+                timer t;
+                wrapper->range_scan({}, {}, 1);
+                full_first_times[i] = t.get<std::micro>();
+            }
+
+            size_t ng = 0;
+            {
+                timer t;
+                for (const range& r : ranges) {
+                    ng += wrapper->range_scan(r.lo, r.hi, SIZE_MAX) != r.num;
+                }
+                range_times[i] = t.get<std::micro>();
+            }
+            {
+                timer t;
+                for (const range& r : ranges) {
+                    ng += wrapper->range_scan(r.lo, r.hi, 1) != 1;
+                }
+                range_first_times[i] = t.get<std::micro>();
+            }
+            if (ng != 0) {
+                std::cerr << "critical error for range scan results" << std::endl;
+                return 1;
+            }
+        }
+
+        size_t num_scanned = 0;
+        for (const range& r : ranges) {
+            num_scanned += r.num;
+        }
+        const size_t num_ranges = std::max<size_t>(1, ranges.size());
 
-template <uint64_t ChunkSize>
-struct poplar_wrapper_trait<poplar_types::PLAIN_BONSAI, ChunkSize> {
-    using type = poplar::plain_bonsai_map<int>;
-    static std::string name() {
-        return "poplar_plain_bonsai (PDT-PB)";
-    }
-};
-template <uint64_t ChunkSize>
-struct poplar_wrapper_trait<poplar_types::SEMI_COMPACT_BONSAI, ChunkSize> {
-    using type = poplar::semi_compact_bonsai_map<int, ChunkSize>;
-    static std::string name() {
-        return "poplar_semi_compact_bonsai_" + std::to_string(ChunkSize) + " (PDT-SB)";
-    }
-};
-template <uint64_t ChunkSize>
-struct poplar_wrapper_trait<poplar_types::COMPACT_BONSAI, ChunkSize> {
-    using type = poplar::compact_bonsai_map<int, ChunkSize>;
-    static std::string name() {
-        return "poplar_compact_bonsai_" + std::to_string(ChunkSize) + " (PDT-CB)";
-    }
-};
-template <uint64_t ChunkSize>
-struct poplar_wrapper_trait<poplar_types::PLAIN_FKHASH, ChunkSize> {
-    using type = poplar::plain_fkhash_map<int>;
-    static std::string name() {
-        return "poplar_plain_fkhash (PDT-PFK)";
+        std::cout << "mode:scan\n"
+                  << "name:" << Wrapper::name() << '\n'
+                  << "key_fn:" << opts.key_fn << '\n'
+                  << "num_keys:" << num_keys << '\n'
+                  << "scan_runs:" << runs << '\n'
+                  << "full_scan_us:" << get_average(full_times) << '\n'
+                  << "best_full_scan_us:" << get_min(full_times) << '\n'
+                  << "full_scan_keys_per_sec:" << num_keys / get_average(full_times) * 1e6 << '\n'
+                  << "full_scan_first_us:" << get_average(full_first_times) << '\n'
+                  << "num_ranges:" << ranges.size() << '\n'
+                  << "scan_span:" << opts.scan_span << '\n';
+        if (!ranges.empty()) {
+            std::cout << "range_us_per_range:" << get_average(range_times) / num_ranges << '\n'
+                      << "best_range_us_per_range:" << get_min(range_times) / num_ranges << '\n'
+                      << "range_keys_per_sec:" << num_scanned / get_average(range_times) * 1e6 << '\n'
+                      << "range_first_us:" << get_average(range_first_times) / num_ranges << '\n';
+        }
+        std::cout << "-- extra stats --\n";
+        wrapper->show_stat(std::cout);
+
+        return 0;
     }
-};
-template <uint64_t ChunkSize>
-struct poplar_wrapper_trait<poplar_types::SEMI_COMPACT_FKHASH, ChunkSize> {
-    using type = poplar::semi_compact_fkhash_map<int, ChunkSize>;
-    static std::string name() {
-        return "poplar_semi_compact_fkhash_" + std::to_string(ChunkSize) + " (PDT-SFK)";
+}
+
+// Inserts the keys in doubling prefixes, i.e., the first scaling, 2 * scaling, ... keys up to all of them, and
+// checkpoints after each. A checkpoint measures searches for scaling_sample keys drawn uniformly from those
+// inserted, the bytes per key and the stats of the wrapper, so that a single run shows where a structure
+// falls out of the caches and the TLB reach.
+template <class Wrapper>
+int bench_scaling(const bench_options& opts) {
+    const int runs = opts.runs;
+    const std::vector<std::string>& args = opts.args;
+
+    key_arena keys;
+    if (!keys.load(opts.key_fn)) {
+        std::cerr << "open error: key_fn = " << opts.key_fn << std::endl;
+        return 1;
     }
-};
-template <uint64_t ChunkSize>
-struct poplar_wrapper_trait<poplar_types::COMPACT_FKHASH, ChunkSize> {
-    using type = poplar::compact_fkhash_map<int, ChunkSize>;
-    static std::string name() {
-        return "poplar_compact_fkhash_" + std::to_string(ChunkSize) + " (PDT-CFK)";
+    std::vector<std::string_view> insert_keys(keys.begin(), keys.end());
+    if (!reorder_keys(insert_keys, opts.order, opts.seed, opts.cluster_bytes)) {
+        std::cerr << "error: invalid order = " << opts.order << std::endl;
+        return 1;
     }
-};
+    const size_t num_keys = insert_keys.size();
 
-template <poplar_types T, uint64_t ChunkSize = 0>
-class poplar_wrapper {
-  public:
-    explicit poplar_wrapper(const std::vector<std::string>& args) {
-        if (args.size() >= 2) {
-            uint32_t capa_bits = std::stoul(args[0]);
-            uint64_t lambda = std::stoul(args[1]);
-            dict_ = typename poplar_wrapper_trait<T, ChunkSize>::type(capa_bits, lambda);
+    struct checkpoint {
+        size_t num_keys;
+        double insert_us_per_key;  // of the keys inserted since the previous checkpoint
+        double search_ns_per_query;
+        double best_search_ns_per_query;
+        int64_t heap_live_bytes;
+        int64_t process_size;
+        std::string stats;
+    };
+    std::vector<checkpoint> checkpoints;
+    {
+        size_t num_checkpoints = 1;
+        for (size_t end = std::min(opts.scaling, num_keys); end < num_keys; end *= 2) {
+            ++num_checkpoints;
         }
+        checkpoints.reserve(num_checkpoints);
     }
-    static std::string name() {
-        return poplar_wrapper_trait<T, ChunkSize>::name();
-    }
-    bool insert(const std::string& key) {
-        *dict_.update(poplar::make_char_range(key)) = 1;
-        return true;
+
+    keygen::random rnd(opts.seed + 1);
+    std::vector<lookup_key_t<Wrapper>> sample(opts.scaling_sample);
+    std::vector<double> times(runs);
+
+    // Heap and RSS are relative to those before the build. The stats kept for the report and the sampled queries
+    // (std::string for lookup_by_string) are allocated during the build, so their bytes are excluded from the heap.
+    const int64_t live_beg = alloc_tracker::live_bytes();
+    int64_t harness_bytes = 0;
+    const int64_t process_beg = static_cast<int64_t>(get_process_size());
+    auto wrapper = std::make_unique<Wrapper>(args);
+
+    for (size_t beg = 0, end = std::min(opts.scaling, num_keys); beg < num_keys;
+         beg = end, end = std::min(2 * end, num_keys)) {
+        checkpoint c;
+        c.num_keys = end;
+        {
+            timer t;
+            for (size_t i = beg; i < end; ++i) {
+                wrapper->insert(insert_keys[i]);
+            }
+            c.insert_us_per_key = t.get<std::micro>() / (end - beg);
+        }
+        c.heap_live_bytes = alloc_tracker::live_bytes() - live_beg - harness_bytes;
+        c.process_size = static_cast<int64_t>(get_process_size()) - process_beg;
+
+        const int64_t live_before_sample = alloc_tracker::live_bytes();
+        for (auto& key : sample) {
+            key = insert_keys[rnd.next_below(end)];
+        }
+        harness_bytes += alloc_tracker::live_bytes() - live_before_sample;
+        for (int i = 0; i < runs; ++i) {
+            size_t ok = 0;
+            timer t;
+            for (const auto& key : sample) {
+                ok += wrapper->search(key);
+            }
+            times[i] = t.get<std::nano>();
+            if (ok != sample.size()) {
+                std::cerr << "critical error for search results at " << end << " keys" << std::endl;
+                return 1;
+            }
+        }
+        c.search_ns_per_query = get_average(times) / std::max<size_t>(1, sample.size());
+        c.best_search_ns_per_query = get_min(times) / std::max<size_t>(1, sample.size());
+
+        const int64_t live_before_stats = alloc_tracker::live_bytes();
+        {
+            std::ostringstream oss;
+            wrapper->show_stat(oss);
+            c.stats = oss.str();
+        }
+        checkpoints.push_back(std::move(c));
+        harness_bytes += alloc_tracker::live_bytes() - live_before_stats;
     }
-    bool search(const std::string& key) {
-        return *dict_.find(poplar::make_char_range(key));
+
+    std::cout << "mode:scaling\n"
+              << "name:" << Wrapper::name() << '\n'
+              << "key_fn:" << opts.key_fn << '\n'
+              << "order:" << opts.order << '\n'
+              << "cluster_bytes:" << opts.cluster_bytes << '\n'
+              << "num_keys:" << num_keys << '\n'
+              << "search_runs:" << runs << '\n'
+              << "scaling_sample:" << opts.scaling_sample << '\n'
+              << "num_checkpoints:" << checkpoints.size() << '\n';
+    for (size_t s = 0; s < checkpoints.size(); ++s) {
+        const checkpoint& c = checkpoints[s];
+        const std::string pfx = "step_" + std::to_string(s);
+        std::cout << pfx << "_num_keys:" << c.num_keys << '\n'
+                  << pfx << "_insert_us_per_key:" << c.insert_us_per_key << '\n'
+                  << pfx << "_search_ns_per_query:" << c.search_ns_per_query << '\n'
+                  << pfx << "_best_search_ns_per_query:" << c.best_search_ns_per_query << '\n'
+                  << pfx << "_process_bytes_per_key:" << double(c.process_size) / c.num_keys << '\n';
+        if (alloc_tracker::enabled()) {
+            std::cout << pfx << "_heap_bytes_per_key:" << double(c.heap_live_bytes) / c.num_keys << '\n';
+        }
     }
-    void show_stat(std::ostream& os) const {
-        dict_.show_stats(os);
+    // the stats at each checkpoint are nested under its step
+    std::cout << "-- extra stats --\n";
+    for (size_t s = 0; s < checkpoints.size(); ++s) {
+        std::cout << "step_" << s << ":\n";
+        std::istringstream iss(checkpoints[s].stats);
+        for (std::string line; std::getline(iss, line);) {
+            std::cout << "    " << line << '\n';
+        }
     }
 
-  private:
-    typename poplar_wrapper_trait<T, ChunkSize>::type dict_;
-};
+    return 0;
+}
 
+// Builds the dictionary from a part of the keys and then replays a pre-generated trace of mixed operations.
 template <class Wrapper>
-int bench(int runs, const std::string& key_fn, const std::string& query_fn, const std::vector<std::string>& args) {
-    auto wrapper = std::make_unique<Wrapper>(args);
+int bench_workload(const bench_options& opts) {
+    const int runs = opts.runs;
+    const std::vector<std::string>& args = opts.args;
 
-    size_t num_keys = 0, num_queries = 0;
-    size_t ok = 0, ng = 0;
-    size_t process_size = get_process_size();
-    double constr_sec = 0.0;
-    double insert_us_per_key = 0.0, search_us_per_query = 0.0;
-    double best_insert_us_per_key = 0.0, best_search_us_per_query = 0.0;
+    key_arena keys;
+    if (!keys.load(opts.key_fn)) {
+        std::cerr << "open error: key_fn = " << opts.key_fn << std::endl;
+        return 1;
+    }
 
-    {
-        std::ifstream ifs(key_fn);
-        if (!ifs) {
-            std::cerr << "open error: key_fn = " << key_fn << std::endl;
-            return 1;
-        }
+    workload_spec spec;
+    if (!parse_workload(opts.workload, spec)) {
+        std::cerr << "error: invalid workload = " << opts.workload << std::endl;
+        return 1;
+    }
+    if (!opts.key_dist.empty()) {
+        spec.key_dist = opts.key_dist;
+    }
 
-        std::string key;
-        key.reserve(1024);
+    const uint64_t num_ops = opts.num_ops != 0 ? opts.num_ops : keys.size();
+    std::vector<workload_op> trace;
+    uint64_t num_loaded = 0;
+    if (!make_trace(spec, keys.size(), num_ops, opts.zipf_theta, opts.seed, trace, num_loaded)) {
+        std::cerr << "error: the workload cannot be generated from " << keys.size() << " keys" << std::endl;
+        return 1;
+    }
 
-        size_t num_keys = 0;
+    std::array<size_t, 3> num_each_ops = {};
+    for (const auto& op : trace) {
+        ++num_each_ops[static_cast<int>(op.type)];
+    }
+    const auto lookup_keys = make_lookup_keys<Wrapper>(keys.begin(), keys.end());
 
-        timer t;
-        while (std::getline(ifs, key)) {
-            wrapper->insert(key);
-            ++num_keys;
+    std::unique_ptr<Wrapper> wrapper;
+    auto load = [&]() {
+        wrapper.reset();
+        wrapper = std::make_unique<Wrapper>(args);
+        for (uint64_t i = 0; i < num_loaded; ++i) {
+            wrapper->insert(keys[i]);
         }
-        constr_sec = t.get<>();
-        process_size = get_process_size() - process_size;
-    }
+    };
 
-    std::shared_ptr<std::vector<std::string>> keys;
-    std::shared_ptr<std::vector<std::string>> queries;
+    size_t ok = 0, ng = 0;
+    std::vector<double> op_times(runs);
 
-    {
-        std::ifstream ifs(key_fn);
-        if (!ifs) {
-            std::cerr << "open error: key_fn = " << key_fn << std::endl;
-            return 1;
-        }
-        keys = std::make_shared<std::vector<std::string>>();
-        for (std::string line; std::getline(ifs, line);) {
-            keys->push_back(line);
+    for (int i = 0; i < runs; ++i) {
+        load();
+
+        size_t _ok = 0;
+        timer t;
+        for (const auto& op : trace) {
+            switch (op.type) {
+                case op_types::READ:
+                    _ok += wrapper->search(lookup_keys[op.key_id]);
+                    break;
+                case op_types::UPDATE:
+                    wrapper->update(lookup_keys[op.key_id]);
+                    break;
+                case op_types::INSERT:
+                    wrapper->insert(keys[op.key_id]);
+                    break;
+            }
         }
-    }
+        op_times[i] = t.get<std::micro>() / trace.size();
 
-    if (query_fn != "-") {
-        std::ifstream ifs(query_fn);
-        if (!ifs) {
-            std::cerr << "open error: query_fn = " << query_fn << std::endl;
+        size_t _ng = num_each_ops[static_cast<int>(op_types::READ)] - _ok;
+        if ((i != 0) and ((ok != _ok) or (ng != _ng))) {
+            std::cerr << "critical error for search results" << std::endl;
             return 1;
         }
-        queries = std::make_shared<std::vector<std::string>>();
-        for (std::string line; std::getline(ifs, line);) {
-            queries->push_back(line);
-        }
-    } else {
-        queries = keys;
+        ok = _ok;
+        ng = _ng;
     }
 
-    {
-        std::vector<double> insert_times(runs);
-        std::vector<double> search_times(runs);
-
-        for (int i = 0; i < runs; ++i) {
-            wrapper = std::make_unique<Wrapper>(args);
+    std::cout << "mode:workload\n"
+              << "name:" << Wrapper::name() << '\n'
+              << "key_fn:" << opts.key_fn << '\n'
+              << "workload:" << opts.workload << '\n'
+              << "read_percent:" << spec.read << '\n'
+              << "update_percent:" << spec.update << '\n'
+              << "insert_percent:" << spec.insert << '\n'
+              << "key_dist:" << spec.key_dist << '\n'
+              << "zipf_theta:" << opts.zipf_theta << '\n'
+              << "seed:" << opts.seed << '\n'
+              << "num_loaded_keys:" << num_loaded << '\n'
+              << "num_ops:" << trace.size() << '\n'
+              << "num_reads:" << num_each_ops[static_cast<int>(op_types::READ)] << '\n'
+              << "num_updates:" << num_each_ops[static_cast<int>(op_types::UPDATE)] << '\n'
+              << "num_inserts:" << num_each_ops[static_cast<int>(op_types::INSERT)] << '\n'
+              << "runs:" << runs << '\n'
+              << "us_per_op:" << get_average(op_times) << '\n'
+              << "best_us_per_op:" << get_min(op_times) << '\n'
+              << "mops:" << 1.0 / get_average(op_times) << '\n'
+              << "ok:" << ok << '\n'
+              << "ng:" << ng << '\n';
 
-            // insertion
-            {
-                timer t;
-                for (const std::string& key : *keys) {
-                    wrapper->insert(key);
-                }
-                insert_times[i] = t.get<std::micro>() / keys->size();
-            }
+    if (opts.latency) {
+        const uint64_t timer_overhead_ns = measure_timer_overhead();
+        std::array<latency_histogram, 3> hists;
 
-            // retrieval
-            size_t _ok = 0, _ng = 0;
-            {
-                timer t;
-                for (const std::string& query : *queries) {
-                    if (wrapper->search(query)) {
-                        ++_ok;
-                    } else {
-                        ++_ng;
-                    }
-                }
-                search_times[i] = t.get<std::micro>() / queries->size();
+        load();
+        for (const auto& op : trace) {
+            uint64_t beg = now_ns();
+            switch (op.type) {
+                case op_types::READ:
+                    wrapper->search(lookup_keys[op.key_id]);
+                    break;
+                case op_types::UPDATE:
+                    wrapper->update(lookup_keys[op.key_id]);
+                    break;
+                case op_types::INSERT:
+                    wrapper->insert(keys[op.key_id]);
+                    break;
             }
+            uint64_t elapsed = now_ns() - beg;
+            hists[static_cast<int>(op.type)].record(elapsed > timer_overhead_ns ? elapsed - timer_overhead_ns : 0);
+        }
 
-            if (i != 0) {
-                if ((ok != _ok) or (ng != _ng)) {
-                    std::cerr << "critical error for search results" << std::endl;
-                    return 1;
-                }
+        std::cout << "timer_overhead_ns:" << timer_overhead_ns << '\n';
+        const char* pfxs[] = {"read", "update", "insert"};
+        for (int k = 0; k < 3; ++k) {
+            if (hists[k].size() != 0) {
+                show_latency(std::cout, pfxs[k], hists[k]);
             }
-
-            ok = _ok;
-            ng = _ng;
         }
-
-        num_keys = keys->size();
-        num_queries = queries->size();
-        insert_us_per_key = get_average(insert_times);
-        best_insert_us_per_key = get_min(insert_times);
-        search_us_per_query = get_average(search_times);
-        best_search_us_per_query = get_min(search_times);
     }
 
-    std::cout << "mode:measure\n"
-              << "name:" << Wrapper::name() << '\n'
-              << "key_fn:" << key_fn << '\n'
-              << "query_fn:" << query_fn << '\n'
-              << "insert_runs:" << runs << '\n'
-              << "num_keys:" << num_keys << '\n'
-              << "insert_us_per_key:" << insert_us_per_key << '\n'
-              << "best_insert_us_per_key:" << best_insert_us_per_key << '\n'
-              << "search_runs:" << runs << '\n'
-              << "num_queries:" << num_queries << '\n'
-              << "search_us_per_query:" << search_us_per_query << '\n'
-              << "best_search_us_per_query:" << best_search_us_per_query << '\n'
-              << "ok:" << ok << '\n'
-              << "ng:" << ng << '\n'
-              << "process_size:" << process_size << '\n';
     std::cout << "-- extra stats --\n";
     wrapper->show_stat(std::cout);
 
@@ -608,24 +4276,82 @@ using wrapper_types = std::tuple<standard_map_wrapper<standard_map_types::STD_MA
                                  poplar_wrapper<poplar_types::COMPACT_FKHASH, 8>,
                                  poplar_wrapper<poplar_types::COMPACT_FKHASH, 16>,
                                  poplar_wrapper<poplar_types::COMPACT_FKHASH, 32>,
-                                 poplar_wrapper<poplar_types::COMPACT_FKHASH, 64>
+                                 poplar_wrapper<poplar_types::COMPACT_FKHASH, 64>,
+                                 cedar_wrapper<cedar_types::TRIE, true>,
+                                 cedar_wrapper<cedar_types::MP_TRIE, true>,
+                                 standard_map_wrapper<standard_map_types::STD_MAP, payload<8>>,
+                                 standard_map_wrapper<standard_map_types::STD_MAP, payload<16>>,
+                                 standard_map_wrapper<standard_map_types::STD_MAP, payload<32>>,
+                                 tsl_map_wrapper<tsl_map_types::HAT_TRIE, payload<8>>,
+                                 tsl_map_wrapper<tsl_map_types::HAT_TRIE, payload<16>>,
+                                 tsl_map_wrapper<tsl_map_types::HAT_TRIE, payload<32>>,
+                                 tsl_map_wrapper<tsl_map_types::ROBIN, payload<8>>,
+                                 tsl_map_wrapper<tsl_map_types::ROBIN, payload<16>>,
+                                 tsl_map_wrapper<tsl_map_types::ROBIN, payload<32>>,
+                                 poplar_wrapper<poplar_types::PLAIN_BONSAI, 0, payload<8>>,
+                                 poplar_wrapper<poplar_types::PLAIN_BONSAI, 0, payload<16>>,
+                                 poplar_wrapper<poplar_types::PLAIN_BONSAI, 0, payload<32>>,
+                                 poplar_wrapper<poplar_types::COMPACT_BONSAI, 16, payload<8>>,
+                                 poplar_wrapper<poplar_types::COMPACT_BONSAI, 16, payload<16>>,
+                                 poplar_wrapper<poplar_types::COMPACT_BONSAI, 16, payload<32>>,
+                                 poplar_wrapper<poplar_types::COMPACT_FKHASH, 16, payload<8>>,
+                                 poplar_wrapper<poplar_types::COMPACT_FKHASH, 16, payload<16>>,
+                                 poplar_wrapper<poplar_types::COMPACT_FKHASH, 16, payload<32>>
                                  >;
 // clang-format on
 
 constexpr size_t NUM_WRAPPERS = std::tuple_size<wrapper_types>::value;
 
+// Records the placement of the run, which bench numbers depend on.
+inline void show_placement(std::ostream& os, const bench_options& opts) {
+    os << "pin_cpu:" << opts.pin_cpu << '\n'
+       << "numa_node:" << opts.numa_node << '\n'
+       << "thp:" << opts.thp << '\n'
+       << "thp_system:" << huge_pages::system_mode() << '\n';
+}
+
 template <int N = 0>
-int run(const cmdline::parser& p) {
+int run(int wrapper_id, const bench_options& opts) {
     if constexpr (N >= NUM_WRAPPERS) {
         std::cerr << "error: wrapper_id is out of range.\n";
         return 1;
     } else {
-        if (p.get<int>("wrapper_id") - 1 == N) {
+        if (wrapper_id - 1 == N) {
             using wrapper_type = std::tuple_element_t<N, wrapper_types>;
-            return bench<wrapper_type>(p.get<int>("runs"), p.get<std::string>("key_fn"), p.get<std::string>("query_fn"),
-                                       p.rest());
+            show_placement(std::cout, opts);
+            if (opts.threads > 0) {
+                return bench_threads<wrapper_type>(opts);
+            }
+            if (opts.stream) {
+                return bench_stream<wrapper_type>(opts);
+            }
+            if (!opts.loads.empty()) {
+                return bench_open_loop<wrapper_type>(opts);
+            }
+            if (opts.scan >= 0) {
+                return bench_scan<wrapper_type>(opts);
+            }
+            if (!opts.text_fn.empty()) {
+                return bench_tokenize<wrapper_type>(opts);
+            }
+            if (opts.prefix_len > 0) {
+                return bench_prefix<wrapper_type>(opts);
+            }
+            if (opts.scaling > 0) {
+                return bench_scaling<wrapper_type>(opts);
+            }
+            if (opts.churn > 0) {
+                return bench_churn<wrapper_type>(opts);
+            }
+            if (!opts.workload.empty()) {
+                return bench_workload<wrapper_type>(opts);
+            }
+            if (!opts.negative.empty()) {
+                return bench_negative<wrapper_type>(opts);
+            }
+            return bench<wrapper_type>(opts);
         }
-        return run<N + 1>(p);
+        return run<N + 1>(wrapper_id, opts);
     }
 }
 
@@ -639,14 +4365,287 @@ inline void list_all(const char* pfx, std::ostream& os) {
     os << pfx << std::setw(2) << N << ": " << type::name() << '\n';
 }
 
+template <typename Types, size_t N = std::tuple_size_v<Types>>
+inline void get_names(std::vector<std::string>& names) {
+    if constexpr (N > 1) {
+        get_names<Types, N - 1>(names);
+    }
+    names.push_back(std::tuple_element_t<N - 1, Types>::name());
+}
+
+// Parses a comma-separated list of wrapper ids ("3"), ranges ("13-21") and name globs ("poplar_compact_*").
+inline bool parse_wrapper_ids(const std::string& str, std::vector<int>& ids) {
+    std::vector<std::string> names;
+    get_names<wrapper_types>(names);
+
+    std::istringstream iss(str);
+    for (std::string tok; std::getline(iss, tok, ',');) {
+        int beg = 0, end = 0;
+        char tail = 0;
+        bool is_range = std::sscanf(tok.c_str(), "%d-%d%c", &beg, &end, &tail) == 2;
+        if (!is_range and std::sscanf(tok.c_str(), "%d%c", &beg, &tail) == 1) {
+            end = beg;
+            is_range = true;
+        }
+        if (is_range) {
+            if (beg < 1 or NUM_WRAPPERS < size_t(end) or end < beg) {
+                return false;
+            }
+            for (int id = beg; id <= end; ++id) {
+                ids.push_back(id);
+            }
+        } else {
+            for (size_t i = 0; i < names.size(); ++i) {
+                if (fnmatch(tok.c_str(), names[i].c_str(), 0) == 0) {
+                    ids.push_back(static_cast<int>(i + 1));
+                }
+            }
+        }
+    }
+    return !ids.empty();
+}
+
+inline std::vector<std::string> split_list(const std::string& str) {
+    std::vector<std::string> items;
+    std::istringstream iss(str);
+    for (std::string item; std::getline(iss, item, ',');) {
+        items.push_back(item);
+    }
+    return items;
+}
+
+inline std::string csv_quote(const std::string& str) {
+    if (str.find_first_of(",\"\n") == std::string::npos) {
+        return str;
+    }
+    std::string ret = "\"";
+    for (char c : str) {
+        ret += c;
+        if (c == '"') {
+            ret += c;
+        }
+    }
+    return ret + "\"";
+}
+
+inline std::string json_quote(const std::string& str) {
+    std::string ret = "\"";
+    for (char c : str) {
+        if (c == '"' or c == '\\') {
+            ret += '\\';
+        }
+        if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            ret += buf;
+        } else {
+            ret += c;
+        }
+    }
+    return ret + "\"";
+}
+
+// Whether the string is a valid JSON number (strtod() also accepts "nan", "inf" and hexadecimals).
+inline bool is_number(const std::string& str) {
+    char* end = nullptr;
+    double v = std::strtod(str.c_str(), &end);
+    return !str.empty() and *end == '\0' and std::isfinite(v) and str.find_first_of("xX") == std::string::npos;
+}
+
+// Runs a wrapper in a child process, so that allocator state and memory usage are not carried over, and
+// collects its "key:value" lines. Indented extra stats are flattened as "stat.<parent>.<key>".
+inline int run_child(int wrapper_id, const bench_options& opts, std::vector<std::pair<std::string, std::string>>& kvs) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return -1;
+    }
+    std::cout.flush();
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        return -1;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[1]);
+        int ret = run<>(wrapper_id, opts);
+        std::cout.flush();
+        std::_Exit(ret);
+    }
+
+    close(fds[1]);
+    std::string out;
+    char buf[4096];
+    for (ssize_t n; (n = read(fds[0], buf, sizeof(buf))) > 0;) {
+        out.append(buf, n);
+    }
+    close(fds[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    std::istringstream iss(out);
+    bool in_stats = false;
+    std::vector<std::string> parents;
+    for (std::string line; std::getline(iss, line);) {
+        if (line == "-- extra stats --") {
+            in_stats = true;
+            continue;
+        }
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        size_t depth = line.find_first_not_of(' ') / 4;
+        std::string key = line.substr(depth * 4, colon - depth * 4), value = line.substr(colon + 1);
+        if (!in_stats) {
+            kvs.emplace_back(key, value);
+            continue;
+        }
+        parents.resize(std::min(parents.size(), depth));
+        std::string path = "stat";
+        for (const auto& parent : parents) {
+            path += "." + parent;
+        }
+        if (value.empty()) {
+            parents.push_back(key);
+        } else {
+            kvs.emplace_back(path + "." + key, value);
+        }
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+// Benchmarks each selected wrapper on each pair of key/query files and writes one row per metric.
+inline int sweep(const std::string& wrappers, const std::string& format, const bench_options& opts) {
+    std::vector<int> ids;
+    if (!parse_wrapper_ids(wrappers, ids)) {
+        std::cerr << "error: invalid wrapper selection = " << wrappers << std::endl;
+        return 1;
+    }
+    std::vector<std::string> names;
+    get_names<wrapper_types>(names);
+
+    const std::vector<std::string> key_fns = split_list(opts.key_fn);
+    std::vector<std::string> query_fns = split_list(opts.query_fn);
+    if (query_fns.size() == 1) {
+        query_fns.resize(key_fns.size(), query_fns[0]);
+    }
+    if (query_fns.size() != key_fns.size()) {
+        std::cerr << "error: # of query files must be one or the same as that of key files" << std::endl;
+        return 1;
+    }
+
+    if (format == "csv") {
+        std::cout << "wrapper_id,wrapper,key_fn,query_fn,metric,value\n";
+    }
+
+    int num_failed = 0;
+    for (size_t d = 0; d < key_fns.size(); ++d) {
+        for (int id : ids) {
+            bench_options child_opts = opts;
+            child_opts.key_fn = key_fns[d];
+            child_opts.query_fn = query_fns[d];
+
+            std::vector<std::pair<std::string, std::string>> kvs;
+            int status = run_child(id, child_opts, kvs);
+            kvs.emplace_back("exit_status", std::to_string(status));
+            num_failed += status != 0;
+
+            for (const auto& kv : kvs) {
+                if (kv.first == "name" or kv.first == "key_fn" or kv.first == "query_fn") {
+                    continue;
+                }
+                if (format == "csv") {
+                    std::cout << id << ',' << csv_quote(names[id - 1]) << ',' << csv_quote(key_fns[d]) << ','
+                              << csv_quote(query_fns[d]) << ',' << csv_quote(kv.first) << ','
+                              << csv_quote(kv.second) << '\n';
+                } else {
+                    std::cout << "{\"wrapper_id\":" << id << ",\"wrapper\":" << json_quote(names[id - 1])
+                              << ",\"key_fn\":" << json_quote(key_fns[d])
+                              << ",\"query_fn\":" << json_quote(query_fns[d])
+                              << ",\"metric\":" << json_quote(kv.first) << ",\"value\":"
+                              << (is_number(kv.second) ? kv.second : json_quote(kv.second)) << "}\n";
+                }
+            }
+            std::cout.flush();
+        }
+    }
+    return num_failed != 0 ? 1 : 0;
+}
+
 int main(int argc, char** argv) {
     std::ios::sync_with_stdio(false);
 
     cmdline::parser p;
     p.add<int>("wrapper_id", 'w', "type id of dictionary wrappers", false, 2);
-    p.add<std::string>("key_fn", 'k', "input file name of keywords", false, "");
-    p.add<std::string>("query_fn", 'q', "input file name of queries", false, "-");
+    p.add<std::string>("key_fn", 'k', "input file name of keywords (comma-separated for sweep)", false, "");
+    p.add<std::string>("query_fn", 'q', "input file name of queries (comma-separated for sweep)", false, "-");
     p.add<int>("runs", 'r', "# of runs", false, 10);
+    p.add<int>("threads", 't', "max # of search threads for the read-scaling mode (0 = disabled)", false, 0);
+    p.add<std::string>("slicing", '\0', "query slices of the search threads", false, "shared",
+                       cmdline::oneof<std::string>("shared", "disjoint"));
+    p.add<bool>("latency", '\0', "measure per-operation latency percentiles in an extra run", false, false);
+    p.add<bool>("perf", '\0', "collect hardware performance counters (Linux only)", false, false);
+    p.add<std::string>("workload", '\0', "YCSB-style workload: a, b, c, d or <read>:<update>:<insert> in percent",
+                       false, "");
+    p.add<std::string>("key_dist", '\0', "key selection of the workload (default: that of the workload)", false, "",
+                       cmdline::oneof<std::string>("", "uniform", "zipf", "hotspot", "latest"));
+    p.add<double>("zipf_theta", '\0', "skew of the zipfian key selection", false, 0.99, cmdline::range(0.0, 0.9999));
+    p.add<uint64_t>("num_ops", '\0', "# of operations of the workload (0 = # of keys)", false, 0);
+    p.add<uint64_t>("seed", 's', "random seed", false, 0);
+    p.add<std::string>("negative", '\0', "search for absent queries derived from the keys", false, "",
+                       cmdline::oneof<std::string>("", "random", "mutate", "truncate", "extend"));
+    p.add<double>("miss_ratio", '\0', "ratio of absent queries", false, 0.5, cmdline::range(0.0, 1.0));
+    p.add<bool>("batch", 'b', "also measure batched retrieval", false, false);
+    p.add<double>("erase_ratio", 'e', "ratio of keys erased after the runs (0 = disabled)", false, 0.0,
+                  cmdline::range(0.0, 1.0));
+    p.add<std::string>("cache_state", '\0', "also measure searches with caches evicted (cold)", false, "warm",
+                       cmdline::oneof<std::string>("warm", "cold"));
+    p.add<size_t>("expected_keys", '\0', "# of keys for which pre-sized builds are also measured (0 = disabled)",
+                  false, 0);
+    p.add<std::string>("save_fn", '\0', "file name to which the dictionary is saved and from which it is loaded", false,
+                       "");
+    p.add<std::string>("growth_trace", '\0', "CSV file name to which growth events on insertion are written", false,
+                       "");
+    p.add<int>("churn", '\0', "# of rounds of the steady-state churn mode (0 = disabled)", false, 0);
+    p.add<double>("churn_ratio", '\0', "ratio of the resident keys replaced in a churn round", false, 0.1,
+                  cmdline::range(0.0, 1.0));
+    p.add<size_t>("prefix_len", '\0', "length in bytes of the query prefixes of the prefix-search mode (0 = disabled)",
+                  false, 0);
+    p.add<size_t>("prefix_limit", '\0', "max # of completions enumerated per prefix (0 = all)", false, 0);
+    p.add<std::string>("tokenize", '\0', "input file name of a text tokenized with the keys", false, "");
+    p.add<std::string>("match", '\0', "matches of the tokenization", false, "all",
+                       cmdline::oneof<std::string>("all", "longest"));
+    p.add<int>("scan", '\0', "# of range scans of the ordered-scan mode, which also scans all the keys (-1 = disabled)",
+               false, -1);
+    p.add<size_t>("scan_span", '\0', "# of keys in a range scan", false, 100);
+    p.add<size_t>("scaling", '\0', "# of keys at the first checkpoint of the scaling-curve mode (0 = disabled)", false,
+                  0);
+    p.add<size_t>("scaling_sample", '\0', "# of searches at each checkpoint of the scaling curve", false, 100000);
+    p.add<bool>("stream", '\0', "stream the keys from key_fn or gen:<preset>:<num_keys> without holding them", false,
+                false);
+    p.add<std::string>("open_loop", '\0', "offered loads of the open-loop mode in queries/sec or % of saturation",
+                       false, "");
+    p.add<std::string>("arrival", '\0', "arrival process of the open-loop mode", false, "poisson",
+                       cmdline::oneof<std::string>("constant", "poisson"));
+    p.add<int>("workers", '\0', "# of search threads of the open-loop mode", false, 1, cmdline::range(1, 1024));
+    p.add<int>("pin_cpu", '\0',
+               "pin the benchmark threads to the logical CPUs from this one (-1 = only those of -t and --open_loop, "
+               "from CPU 0)",
+               false, -1);
+    p.add<int>("numa_node", '\0', "bind the memory to this NUMA node (-1 = not bound; Linux only)", false, -1);
+    p.add<std::string>("thp", '\0', "transparent huge pages for large allocations", false, "default",
+                       cmdline::oneof<std::string>("default", "always", "never"));
+    p.add<std::string>("sweep", '\0', "run the selected wrappers (e.g., 1-12,poplar_compact_*) in child processes",
+                       false, "");
+    p.add<std::string>("format", '\0', "output format of the sweep", false, "csv",
+                       cmdline::oneof<std::string>("csv", "json"));
+    p.add<std::string>("order", 'o', "insertion order of the keys", false, "file",
+                       cmdline::oneof<std::string>("file", "sorted", "reverse", "shuffle", "clustered"));
+    p.add<size_t>("cluster_bytes", '\0', "# of leading bytes shared by the keys of a cluster in the clustered order",
+                  false, 3, cmdline::range<size_t>(1, 1024));
     p.add<bool>("list_all", 'l', "list all dictionary wrappers", false, false);
     p.parse_check(argc, argv);
 
@@ -656,7 +4655,67 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    if ((p.get<std::string>("key_fn").empty()) or (run<>(p) != 0)) {
+    bench_options opts;
+    opts.runs = p.get<int>("runs");
+    opts.key_fn = p.get<std::string>("key_fn");
+    opts.query_fn = p.get<std::string>("query_fn");
+    opts.args = p.rest();
+    opts.threads = p.get<int>("threads");
+    opts.disjoint = p.get<std::string>("slicing") == "disjoint";
+    opts.latency = p.get<bool>("latency");
+    opts.perf = p.get<bool>("perf");
+    opts.workload = p.get<std::string>("workload");
+    opts.key_dist = p.get<std::string>("key_dist");
+    opts.zipf_theta = p.get<double>("zipf_theta");
+    opts.num_ops = p.get<uint64_t>("num_ops");
+    opts.seed = p.get<uint64_t>("seed");
+    opts.negative = p.get<std::string>("negative");
+    opts.miss_ratio = p.get<double>("miss_ratio");
+    opts.order = p.get<std::string>("order");
+    opts.cluster_bytes = p.get<size_t>("cluster_bytes");
+    opts.batch = p.get<bool>("batch");
+    opts.erase_ratio = p.get<double>("erase_ratio");
+    opts.cache_state = p.get<std::string>("cache_state");
+    opts.expected_keys = p.get<size_t>("expected_keys");
+    opts.save_fn = p.get<std::string>("save_fn");
+    opts.growth_trace = p.get<std::string>("growth_trace");
+    opts.churn = p.get<int>("churn");
+    opts.churn_ratio = p.get<double>("churn_ratio");
+    opts.prefix_len = p.get<size_t>("prefix_len");
+    opts.prefix_limit = p.get<size_t>("prefix_limit");
+    opts.text_fn = p.get<std::string>("tokenize");
+    opts.match = p.get<std::string>("match");
+    opts.scan = p.get<int>("scan");
+    opts.scan_span = p.get<size_t>("scan_span");
+    opts.scaling = p.get<size_t>("scaling");
+    opts.scaling_sample = p.get<size_t>("scaling_sample");
+    opts.stream = p.get<bool>("stream");
+    opts.loads = split_list(p.get<std::string>("open_loop"));
+    opts.arrival = p.get<std::string>("arrival");
+    opts.workers = p.get<int>("workers");
+    opts.pin_cpu = p.get<int>("pin_cpu");
+    opts.numa_node = p.get<int>("numa_node");
+    opts.thp = p.get<std::string>("thp");
+
+    // applied before anything is allocated for the run, and inherited by the children of the sweep
+    if (opts.pin_cpu >= 0 and !pin_thread(opts.pin_cpu)) {
+        std::cerr << "error: cannot pin to CPU " << opts.pin_cpu << std::endl;
+        return 1;
+    }
+    if (opts.numa_node >= 0 and !bind_numa_node(opts.numa_node)) {
+        std::cerr << "error: cannot bind memory to NUMA node " << opts.numa_node << std::endl;
+        return 1;
+    }
+    if (!huge_pages::set_mode(opts.thp)) {
+        std::cerr << "error: cannot set transparent huge pages to " << opts.thp << std::endl;
+        return 1;
+    }
+
+    if (!opts.key_fn.empty() and !p.get<std::string>("sweep").empty()) {
+        return sweep(p.get<std::string>("sweep"), p.get<std::string>("format"), opts);
+    }
+
+    if ((opts.key_fn.empty()) or (run<>(p.get<int>("wrapper_id"), opts) != 0)) {
         std::cerr << p.usage();
         std::cerr << "wrapper_ids:\n";
         list_all<wrapper_types>("  - ", std::cerr);
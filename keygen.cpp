@@ -0,0 +1,97 @@
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <unordered_set>
+
+#include "cmdline.h"
+#include "keygen.hpp"
+
+int main(int argc, char** argv) {
+    std::ios::sync_with_stdio(false);
+
+    cmdline::parser p;
+    p.add<uint64_t>("num_keys", 'n', "# of keys", false, 10000);
+    p.add<uint64_t>("seed", 's', "random seed", false, 0);
+    p.add<std::string>("preset", 'p', "base configuration", false, "none",
+                       cmdline::oneof<std::string>("none", "url", "hex", "dna", "numeric"));
+    p.add<uint32_t>("alphabet_size", 'a', "# of distinct characters taken from the printable ASCII", false, 36);
+    p.add<std::string>("alphabet", '\0', "characters used (overrides alphabet_size)", false, "");
+    p.add<std::string>("length_dist", 'd', "distribution of the key length", false, "uniform",
+                       cmdline::oneof<std::string>("fixed", "uniform", "normal"));
+    p.add<uint32_t>("min_length", '\0', "min length after the shared prefix", false, 4);
+    p.add<uint32_t>("max_length", '\0', "max length after the shared prefix", false, 16);
+    p.add<uint32_t>("prefix_depth", '\0', "length of the shared prefixes", false, 0);
+    p.add<uint32_t>("num_prefixes", '\0', "# of distinct shared prefixes", false, 1);
+    p.add<std::string>("head", '\0', "fixed string put in front of every key", false, "");
+    p.add<bool>("unique", 'u', "skip duplicate keys", false, false);
+    p.add<std::string>("out_fn", 'o', "output file name (- for stdout)", false, "-");
+    p.parse_check(argc, argv);
+
+    keygen::config conf = keygen::config::preset(p.get<std::string>("preset"));
+    conf.seed = p.get<uint64_t>("seed");
+    // options given explicitly override the preset
+    if (p.exist("alphabet_size")) {
+        uint32_t size = std::min<uint32_t>(p.get<uint32_t>("alphabet_size"), sizeof(keygen::BASE_ALPHABET) - 1);
+        conf.alphabet = std::string(keygen::BASE_ALPHABET, size);
+    }
+    if (p.exist("alphabet")) {
+        conf.alphabet = p.get<std::string>("alphabet");
+    }
+    if (p.exist("length_dist")) {
+        conf.length_dist = keygen::parse_length_dist(p.get<std::string>("length_dist"));
+    }
+    if (p.exist("min_length")) {
+        conf.min_length = p.get<uint32_t>("min_length");
+    }
+    if (p.exist("max_length")) {
+        conf.max_length = p.get<uint32_t>("max_length");
+    }
+    if (p.exist("prefix_depth")) {
+        conf.prefix_depth = p.get<uint32_t>("prefix_depth");
+    }
+    if (p.exist("num_prefixes")) {
+        conf.num_prefixes = p.get<uint32_t>("num_prefixes");
+    }
+    if (p.exist("head")) {
+        conf.head = p.get<std::string>("head");
+    }
+
+    std::unique_ptr<keygen::generator> gen;
+    try {
+        gen = std::make_unique<keygen::generator>(conf);
+    } catch (const std::exception& ex) {
+        std::cerr << "error: " << ex.what() << '\n' << p.usage();
+        return 1;
+    }
+
+    std::ofstream ofs;
+    const std::string out_fn = p.get<std::string>("out_fn");
+    if (out_fn != "-") {
+        ofs.open(out_fn);
+        if (!ofs) {
+            std::cerr << "open error: out_fn = " << out_fn << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& os = out_fn != "-" ? ofs : std::cout;
+
+    const uint64_t num_keys = p.get<uint64_t>("num_keys");
+    const bool unique = p.get<bool>("unique");
+
+    std::unordered_set<std::string> seen;
+    std::string key;
+    for (uint64_t i = 0, n = 0; n < num_keys; ++i) {
+        if (unique and i >= num_keys * 100) {
+            std::cerr << "error: the configuration cannot produce " << num_keys << " unique keys" << std::endl;
+            return 1;
+        }
+        gen->get(i, key);
+        if (unique and !seen.insert(key).second) {
+            continue;
+        }
+        os << key << '\n';
+        ++n;
+    }
+
+    return 0;
+}
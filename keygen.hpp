@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ *  Synthetic keysets
+ *
+ *  Every key is derived only from the configuration and its index, so keysets are reproducible on any platform
+ *  (std::*_distribution is not) and any key can be regenerated without storing the keyset.
+ */
+namespace keygen {
+
+// SplitMix64
+class random {
+  public:
+    explicit random(uint64_t seed) : state_(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state_ += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    // in [0, n)
+    uint64_t next_below(uint64_t n) {
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(next()) * n) >> 64);
+    }
+    // in [0, 1)
+    double next_double() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+  private:
+    uint64_t state_;
+};
+
+inline uint64_t mix(uint64_t seed, uint64_t i) {
+    return random(seed ^ (i * 0xd1342543de82ef95ULL)).next();
+}
+
+enum class length_dists { FIXED, UNIFORM, NORMAL };
+
+inline length_dists parse_length_dist(const std::string& name) {
+    if (name == "fixed") {
+        return length_dists::FIXED;
+    } else if (name == "uniform") {
+        return length_dists::UNIFORM;
+    } else if (name == "normal") {
+        return length_dists::NORMAL;
+    }
+    throw std::invalid_argument("unknown length distribution: " + name);
+}
+
+// printable ASCII without the space, ordered so that small alphabets are alphanumeric
+constexpr char BASE_ALPHABET[] =
+    "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ!\"#$%&'()*+,-./:;<=>?@[\\]^_`{|}~";
+
+struct config {
+    uint64_t seed = 0;
+    std::string alphabet = std::string(BASE_ALPHABET, 26 + 10);
+    // length of the part following the shared prefix
+    length_dists length_dist = length_dists::UNIFORM;
+    uint32_t min_length = 4;
+    uint32_t max_length = 16;
+    // each key starts with one of num_prefixes random strings of prefix_depth characters
+    uint32_t prefix_depth = 0;
+    uint32_t num_prefixes = 1;
+    // fixed string put in front of every key (e.g., "https://")
+    std::string head;
+
+    // Presets modeling typical production keys: "url", "hex", "dna" and "numeric".
+    static config preset(const std::string& name) {
+        config conf;
+        if (name == "url") {
+            conf.head = "https://";
+            conf.alphabet = std::string(BASE_ALPHABET, 36) + "/-_.";
+            conf.length_dist = length_dists::NORMAL;
+            conf.min_length = 8;
+            conf.max_length = 96;
+            conf.prefix_depth = 24;
+            conf.num_prefixes = 64;
+        } else if (name == "hex") {
+            conf.alphabet = std::string(BASE_ALPHABET, 16);
+            conf.length_dist = length_dists::FIXED;
+            conf.min_length = conf.max_length = 32;
+        } else if (name == "dna") {
+            conf.alphabet = "ACGT";
+            conf.length_dist = length_dists::FIXED;
+            conf.min_length = conf.max_length = 31;
+        } else if (name == "numeric") {
+            conf.alphabet = std::string(BASE_ALPHABET, 10);
+            conf.length_dist = length_dists::UNIFORM;
+            conf.min_length = 4;
+            conf.max_length = 12;
+            conf.prefix_depth = 20;
+            conf.num_prefixes = 4;
+        } else if (name != "none") {
+            throw std::invalid_argument("unknown preset: " + name);
+        }
+        return conf;
+    }
+};
+
+class generator {
+  public:
+    explicit generator(const config& conf) : conf_(conf) {
+        if (conf_.alphabet.empty() or conf_.min_length > conf_.max_length or conf_.num_prefixes == 0) {
+            throw std::invalid_argument("invalid keygen config");
+        }
+        prefixes_.resize(conf_.num_prefixes);
+        for (uint32_t j = 0; j < conf_.num_prefixes; ++j) {
+            random rnd(mix(~conf_.seed, j));
+            append_random_(rnd, conf_.prefix_depth, prefixes_[j]);
+        }
+    }
+
+    const config& get_config() const {
+        return conf_;
+    }
+
+    // Writes the i-th key to key.
+    void get(uint64_t i, std::string& key) const {
+        random rnd(mix(conf_.seed, i));
+        key = conf_.head;
+        key += prefixes_[conf_.num_prefixes == 1 ? 0 : rnd.next_below(conf_.num_prefixes)];
+        append_random_(rnd, draw_length_(rnd), key);
+    }
+    std::string get(uint64_t i) const {
+        std::string key;
+        get(i, key);
+        return key;
+    }
+
+  private:
+    config conf_;
+    std::vector<std::string> prefixes_;
+
+    uint32_t draw_length_(random& rnd) const {
+        const uint32_t min = conf_.min_length, max = conf_.max_length;
+        switch (conf_.length_dist) {
+            case length_dists::FIXED:
+                return min;
+            case length_dists::UNIFORM:
+                return min + static_cast<uint32_t>(rnd.next_below(max - min + 1));
+            case length_dists::NORMAL: {
+                // Box-Muller; mean at the middle of [min, max] and 99.7% of the mass within it
+                double u1 = 1.0 - rnd.next_double(), u2 = rnd.next_double();
+                double z = std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+                double len = std::round((min + max) / 2.0 + z * (max - min) / 6.0);
+                return static_cast<uint32_t>(std::min<double>(max, std::max<double>(min, len)));
+            }
+        }
+        return min;
+    }
+    void append_random_(random& rnd, uint32_t length, std::string& str) const {
+        for (uint32_t k = 0; k < length; ++k) {
+            str += conf_.alphabet[rnd.next_below(conf_.alphabet.size())];
+        }
+    }
+};
+
+}  // namespace keygen